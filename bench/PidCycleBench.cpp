@@ -0,0 +1,164 @@
+// External Libraries 
+#include <Arduino.h>
+
+// Custom Libraries
+#include <PidCommand.hpp>
+
+
+/** 
+ * Measures the cost of PidCommand::calculate() and of a single multiply and divide 
+ * for each numeric backend
+ * 
+ * Timer1 runs at the CPU clock (prescaler 1), so every TCNT1 count is one cycle.
+ * Build and upload with `pio run -e uno_pid_bench -t upload`, then open the
+ * serial monitor at 115200 to read the results.
+**/ 
+
+
+const unsigned int iterations = 200; // Number of calculate() calls averaged per backend
+
+// Floating-point backend
+double floatInput = 0, floatOutput = 0, floatSetpoint = 50;
+double floatTime = 0;
+double floatRange[2] = {-100, 100};
+
+// Fixed-point backend
+Fixed16 fixedInput = 0, fixedOutput = 0, fixedSetpoint = 50;
+Fixed16 fixedTime = 0;
+Fixed16 fixedRange[2] = {-100, 100};
+
+/**
+ * @brief Fake clocks advancing 10 ms per call so deltaT never reaches zero
+ */
+double floatClock() { return floatTime += 0.01; }
+Fixed16 fixedClock() { return fixedTime += Fixed16(0.01); }
+
+// Operands of the single operation measurements, volatile so they aren't folded into constants
+volatile double floatA = 12.345, floatB = -0.789, floatResult;
+volatile int32_t fixedA = Fixed16(12.345).getRaw(), fixedB = Fixed16(-0.789).getRaw(), fixedResult;
+
+/**
+ * @brief Single operations measured by measureOperation()
+ */
+struct FloatMultiply { static void run() { floatResult = floatA * floatB; } };
+struct FloatDivide { static void run() { floatResult = floatA / floatB; } };
+struct FixedMultiply { static void run() { fixedResult = (Fixed16::fromRaw(fixedA) * Fixed16::fromRaw(fixedB)).getRaw(); } };
+struct FixedDivide { static void run() { fixedResult = (Fixed16::fromRaw(fixedA) / Fixed16::fromRaw(fixedB)).getRaw(); } };
+
+PidCommand floatPid(&floatInput, &floatOutput, &floatSetpoint, floatRange, floatClock, 1.2, 0.4, 0.05);
+FixedPidCommand fixedPid(&fixedInput, &fixedOutput, &fixedSetpoint, fixedRange, fixedClock, Fixed16(1.2), Fixed16(0.4), Fixed16(0.05));
+
+
+/**
+ * @brief Starts Timer1 as a free running cycle counter
+ */
+void startCycleCounter() {
+  TCCR1A = 0;
+  TCCR1B = _BV(CS10);
+}
+
+
+/**
+ * @brief Measures the average number of cycles a PID command takes to calculate
+ * 
+ * @tparam T Numeric backend of the PID command
+ * @param pid PID command to measure
+ * @param input Input of the PID command, moved towards the output every iteration to keep all terms active
+ * @param output Output of the PID command
+ * @return Average cycles per calculate() call, with the measurement overhead removed
+ */
+template <class T>
+unsigned long measure(BasicPidCommand<T> &pid, T &input, T &output) {
+  unsigned long total = 0;
+  unsigned long overhead = 0;
+
+  for (unsigned int i = 0; i < iterations; i++) {
+    // Overhead of reading the counter
+    noInterrupts();
+    TCNT1 = 0;
+    uint16_t empty = TCNT1;
+    interrupts();
+    overhead += empty;
+
+    noInterrupts();
+    TCNT1 = 0;
+    pid.calculate();
+    uint16_t cycles = TCNT1;
+    interrupts();
+    total += cycles;
+
+    input += output * T(0.01);
+  }
+
+  return (total - overhead) / iterations;
+}
+
+
+/**
+ * @brief Measures the average number of cycles a single operation takes, loads and stores included
+ * 
+ * @tparam Operation Struct with a static run() doing the operation
+ * @return Average cycles per operation, with the measurement overhead removed
+ */
+template <class Operation>
+unsigned long measureOperation() {
+  unsigned long total = 0;
+  unsigned long overhead = 0;
+
+  for (unsigned int i = 0; i < iterations; i++) {
+    noInterrupts();
+    TCNT1 = 0;
+    uint16_t empty = TCNT1;
+    interrupts();
+    overhead += empty;
+
+    noInterrupts();
+    TCNT1 = 0;
+    Operation::run();
+    uint16_t cycles = TCNT1;
+    interrupts();
+    total += cycles;
+  }
+
+  return (total - overhead) / iterations;
+}
+
+
+/**
+ * @brief Prints one line of results
+ */
+void printCycles(const char *name, unsigned long cycles) {
+  Serial.print(name);
+  Serial.print(cycles);
+  Serial.println(" cycles");
+}
+
+
+/**
+ * @brief One time setup code
+ */
+void setup() {
+  Serial.begin(115200);
+  while (!Serial) { delay(20); } // Wait for the Serial port to open 
+
+  // Keeps the integral term active for the whole run
+  floatPid.setIntegrationLimit(1000);
+  fixedPid.setIntegrationLimit(1000);
+
+  startCycleCounter();
+
+  printCycles("double  calculate(): ", measure(floatPid, floatInput, floatOutput));
+  printCycles("Fixed16 calculate(): ", measure(fixedPid, fixedInput, fixedOutput));
+
+  // Fixed16 multiplies and divides use 32 bit math on AVR (FIXED_POINT_NARROW_MATH)
+  printCycles("double  a * b: ", measureOperation<FloatMultiply>());
+  printCycles("Fixed16 a * b: ", measureOperation<FixedMultiply>());
+  printCycles("double  a / b: ", measureOperation<FloatDivide>());
+  printCycles("Fixed16 a / b: ", measureOperation<FixedDivide>());
+}
+
+
+/**
+ * @brief Main code loop
+ */
+void loop() {}
@@ -0,0 +1,88 @@
+#include "ChannelFilter.hpp"
+
+/**
+ * @brief Swaps two values so that a <= b
+ */
+#define SORT_PAIR(a, b) if ((a) > (b)) { int16_t swap = (a); (a) = (b); (b) = swap; }
+
+/* ------------------- ChannelFilter Constructors ------------------ */
+
+const uint8_t ChannelFilter::maxTaps;
+const uint8_t ChannelFilter::maxEmaShift;
+const int16_t ChannelFilter::defaultCenter;
+
+
+ChannelFilter::ChannelFilter(MedianTaps medianTaps, uint8_t shift, uint8_t band, int16_t centerValue) {
+  taps = medianTaps;
+  emaShift = shift < maxEmaShift ? shift : maxEmaShift;
+  deadband = band;
+  center = centerValue;
+}
+
+/* ----------------------------------------------------------------- */
+
+
+
+/* --------------------- ChannelFilter Methods --------------------- */
+
+int16_t ChannelFilter::median() {
+  int16_t a = window[0], b = window[1], c = window[2];
+
+  if (taps == MEDIAN_3) {
+    SORT_PAIR(a, b);
+    SORT_PAIR(b, c);
+    SORT_PAIR(a, b);
+    return b;
+  }
+
+  // Median of 5 in 7 compares, the order of the window doesn't matter
+  int16_t d = window[3], e = window[4];
+  SORT_PAIR(a, b);
+  SORT_PAIR(d, e);
+  SORT_PAIR(a, d);
+  SORT_PAIR(b, e);
+  SORT_PAIR(b, c);
+  SORT_PAIR(c, d);
+  SORT_PAIR(b, c);
+  return c;
+}
+
+
+int16_t ChannelFilter::apply(int16_t value) {
+  // The first value fills the history so the output doesn't ramp up from 0
+  if (!primed) {
+    for (uint8_t i = 0; i < maxTaps; i++) {
+      window[i] = value;
+    }
+    emaSum = (int32_t)value << emaShift;
+    primed = true;
+  }
+
+  // Median of the last few frames
+  if (taps) {
+    window[index] = value;
+    index = index + 1 < taps ? index + 1 : 0;
+    value = median();
+  }
+
+  // Exponential moving average, a shift and two adds per frame
+  if (emaShift) {
+    emaSum += value - ((emaSum + ((int32_t)1 << (emaShift - 1))) >> emaShift);
+    value = (emaSum + ((int32_t)1 << (emaShift - 1))) >> emaShift;
+  }
+
+  // Center deadband
+  if (deadband && value >= center - deadband && value <= center + deadband) {
+    value = center;
+  }
+
+  return value;
+}
+
+
+void ChannelFilter::reset() {
+  index = 0;
+  primed = false;
+}
+
+/* ----------------------------------------------------------------- */
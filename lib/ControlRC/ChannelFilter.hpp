@@ -0,0 +1,80 @@
+#ifndef CHANNEL_FILTER
+#define CHANNEL_FILTER
+
+#include <Arduino.h>
+
+/*-----------------------------------------------------------------------------*/
+/** @file   ChannelFilter.hpp
+ * @brief   Header for ChannelFilter class (integer noise filters for an RC channel)
+*//*---------------------------------------------------------------------------*/
+
+
+/**
+ * @brief Class used to filter the raw values of one RC channel with integer math only
+ * 
+ * @note Stages run in the order median, EMA, deadband, and each one is skipped when it is off.
+ * Meant for joysticks and knobs, the C_SWITCH mapping needs exact switch values so leave SWC unfiltered.
+ */
+class ChannelFilter {
+  public:
+    static const uint8_t maxTaps = 5;        // Largest median window
+    static const uint8_t maxEmaShift = 8;    // Largest EMA shift (Smoothest)
+    static const int16_t defaultCenter = 1500; // Center of an iBus channel
+
+    /**
+     * @brief Size of the median window
+     */
+    enum MedianTaps {
+      MEDIAN_OFF = 0, // No median stage
+      MEDIAN_3 = 3,   // Median of the last 3 values (Removes single-frame spikes)
+      MEDIAN_5 = 5    // Median of the last 5 values (Removes two-frame spikes)
+    };
+
+  private:
+    int16_t window[maxTaps]; // Ring buffer of the last raw values
+    uint8_t taps;            // Median window size (0 when off)
+    uint8_t index = 0;       // Next slot of the ring buffer to write
+
+    uint8_t emaShift;        // EMA coefficient as a shift, 1/2^emaShift of each new value is kept (0 when off)
+    int32_t emaSum = 0;      // EMA state scaled by 2^emaShift
+
+    int16_t center;          // Value the deadband snaps to
+    uint8_t deadband;        // Distance from center that snaps to center (0 when off)
+
+    bool primed = false;     // Condition for if the ring buffer and EMA hold a value yet
+
+    /**
+     * @brief Median of the values in the ring buffer
+     * 
+     * @return Median value
+     */
+    int16_t median();
+
+  public:
+    /**
+     * @brief Defines a channel filter
+     * 
+     * @param medianTaps Median window size (Default off)
+     * @param shift EMA shift from 1 to 8, each frame moves 1/2^shift of the way to the new value (Default 0, off)
+     * @param band Distance from center that snaps to center (Default 0, off)
+     * @param centerValue Value the deadband snaps to (Default 1500)
+     */
+    ChannelFilter(MedianTaps medianTaps = MEDIAN_OFF, uint8_t shift = 0, uint8_t band = 0, int16_t centerValue = defaultCenter);
+
+
+    /**
+     * @brief Filters the next raw value of the channel
+     * 
+     * @param value Raw channel value
+     * @return Filtered channel value
+     */
+    int16_t apply(int16_t value);
+
+
+    /**
+     * @brief Clears the filter history, the next value starts it again
+     */
+    void reset();
+};
+
+#endif // CHANNEL_FILTER
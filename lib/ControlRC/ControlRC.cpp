@@ -1,113 +1,310 @@
 #include "ControlRC.hpp"
 
+const uint8_t ControlRC::channelMapType[numChannels] = {
+  mapType::JOYSTICK, // RIGHT_X
+  mapType::JOYSTICK, // RIGHT_Y
+  mapType::THROTTLE, // LEFT_Y
+  mapType::JOYSTICK, // LEFT_X
+  mapType::SWITCH,   // SWA
+  mapType::SWITCH,   // SWD
+  mapType::SWITCH,   // SWB
+  mapType::C_SWITCH, // SWC
+  mapType::KNOB,     // VRA
+  mapType::KNOB      // VRB
+};
+
+
 ControlRC::ControlRC() {
+  for (uint8_t i = 0; i < numChannels; i++) {
+    channels[i] = 0;
+    filters[i] = nullptr;
+    switchPositions[i] = 0;
+  }
+
+  // Reads as zeroed and in failsafe until the first frame arrives
+  enterFailsafe();
+  frameChanges = pendingChanges = 0;
+
+  // Defaults to mapping every channel onto itself
+  for (uint8_t i = 0; i < numMapTypes; i++) {
+    mapLow[i] = minRC;
+    mapScale[i] = (int32_t)1 << 16;
+  }
+  cSwitchMap[0] = minRC;
+  cSwitchMap[1] = midRC;
+  cSwitchMap[2] = maxRC;
+}
+
+
+void ControlRC::begin() {
   // Begins iBus and Serial communication
-  iBus.begin(Serial);
+  IBusUart::begin(iBusBaudrate);
+}
+
+
+bool ControlRC::update() {
+  uint16_t frame[IBusDecoder::maxChannels];
+
+  // Only copies the channels when a complete frame has arrived since the last update
+  IBusUart::poll();
+  if (!IBusUart::decoder.readFrame(lastSequence, frame)) {
+    // Signal loss, checked on every update so the failsafe is raised within one update of the timeout
+    if (!failsafe && micros() - lastFrameTime > signalTimeout) {
+      enterFailsafe();
+    }
+
+    return false;
+  }
+
+  lastFrameTime = micros();
+  failsafe = false;
+
+  frameChanges = 0;
+  for (uint8_t i = 0; i < numChannels; i++) {
+    isReceiving[i] = frame[i] >= minRC && frame[i] <= maxRC;
+    setChannel(i, filters[i] != nullptr ? filters[i]->apply(frame[i]) : frame[i]);
+  }
+  dispatchSwitchEdges();
+
+  // Only arms from zeroed controls, so a lost signal never comes back with the motor on
+  updateZeroed();
+  if (isZeroed) {
+    armed = true;
+  }
+
+  return true;
+}
+
+
+void ControlRC::setChannel(uint8_t index, int16_t value) {
+  if (channels[index] != value) {
+    channels[index] = value;
+    frameChanges |= (uint16_t)1 << index;
+  }
+}
+
+
+void ControlRC::dispatchSwitchEdges() {
+  pendingChanges |= frameChanges;
+
+  for (uint8_t i = 0; i < numChannels && frameChanges; i++) {
+    if (!(frameChanges & ((uint16_t)1 << i))) {
+      continue;
+    }
+    if (channelMapType[i] != mapType::SWITCH && channelMapType[i] != mapType::C_SWITCH) {
+      continue;
+    }
+
+    // A value change inside a position isn't an edge
+    uint8_t position = getSwitchPosition((ChannelRC)i);
+    if (position == switchPositions[i]) {
+      continue;
+    }
+
+    SwitchEdge edge = position > switchPositions[i] ? SwitchEdge::RISING : SwitchEdge::FALLING;
+    switchPositions[i] = position;
+
+    for (uint8_t h = 0; h < numSwitchHandlers; h++) {
+      if (switchHandlers[h].channel == i) {
+        switchHandlers[h].handler((ChannelRC)i, position, edge);
+      }
+    }
+  }
+}
+
+
+void ControlRC::enterFailsafe() {
+  failsafe = true;
+  armed = false;
+
+  frameChanges = 0;
+  for (uint8_t i = 0; i < numChannels; i++) {
+    isReceiving[i] = false;
+    setChannel(i, channelMapType[i] == mapType::JOYSTICK ? midRC : minRC);
+
+    if (filters[i] != nullptr) {
+      filters[i]->reset();
+    }
+  }
+
+  // Switches read off, so handlers see falling edges
+  dispatchSwitchEdges();
+  updateZeroed();
+}
+
+
+uint16_t ControlRC::getChangedMask() {
+  return frameChanges;
 }
 
 
-void ControlRC::update() {
-  // Joysticks
-  left_x = iBus.readChannel(ChannelRC::LEFT_X);
-  left_y = iBus.readChannel(ChannelRC::LEFT_Y);
-  right_x = iBus.readChannel(ChannelRC::RIGHT_X);
-  right_y = iBus.readChannel(ChannelRC::RIGHT_Y);
+uint16_t ControlRC::takeChanges() {
+  uint16_t changes = pendingChanges;
+  pendingChanges = 0;
+  return changes;
+}
+
+
+bool ControlRC::hasChanged(ChannelRC channel) {
+  return frameChanges & ((uint16_t)1 << channel);
+}
+
+
+bool ControlRC::onSwitch(ChannelRC channel, SwitchHandler handler) {
+  bool isSwitch = channelMapType[channel] == mapType::SWITCH || channelMapType[channel] == mapType::C_SWITCH;
+  if (!isSwitch || handler == nullptr || numSwitchHandlers >= maxSwitchHandlers) {
+    return false;
+  }
+
+  switchHandlers[numSwitchHandlers].channel = channel;
+  switchHandlers[numSwitchHandlers].handler = handler;
+  numSwitchHandlers++;
+  return true;
+}
+
+
+uint8_t ControlRC::getSwitchPosition(ChannelRC channel) {
+  int16_t value = channels[channel];
+  return value <= minRC + zeroTolerance ? 0 : value >= maxRC - zeroTolerance ? 2 : 1;
+}
+
+
+void ControlRC::updateZeroed() {
+  joysticksCentered = channels[throttle] <= minRC + zeroTolerance;
+  knobsOff = true;
+  switchesOff = true;
+
+  for (uint8_t i = 0; i < numChannels; i++) {
+    switch (channelMapType[i]) {
+      case mapType::JOYSTICK:
+        joysticksCentered &= channels[i] >= midRC - zeroTolerance && channels[i] <= midRC + zeroTolerance;
+        break;
+      case mapType::SWITCH:
+      case mapType::C_SWITCH:
+        switchesOff &= channels[i] <= minRC + zeroTolerance;
+        break;
+      case mapType::KNOB:
+        knobsOff &= channels[i] <= minRC + zeroTolerance;
+        break;
+      default:
+        break;
+    }
+  }
+
+  isZeroed = joysticksCentered && switchesOff;
+}
+
+
+void ControlRC::setSignalTimeout(uint32_t timeoutMicros) {
+  signalTimeout = timeoutMicros;
+}
+
+
+uint32_t ControlRC::getFrameAge() {
+  return micros() - lastFrameTime;
+}
 
-  // Switches
-  swa = iBus.readChannel(ChannelRC::SWA);
-  swb = iBus.readChannel(ChannelRC::SWB);
-  swc = iBus.readChannel(ChannelRC::SWC);
-  swd = iBus.readChannel(ChannelRC::SWD);
 
-  // Variable Knobs
-  vra = iBus.readChannel(ChannelRC::VRA);
-  vrb = iBus.readChannel(ChannelRC::VRB);
+bool ControlRC::isFailsafe() {
+  return failsafe;
+}
+
+
+bool ControlRC::isArmed() {
+  return armed;
+}
+
+
+void ControlRC::disarm() {
+  armed = false;
+}
+
+
+bool ControlRC::getZeroed() {
+  return isZeroed;
+}
+
+
+bool ControlRC::getReceiving(ChannelRC channel) {
+  return isReceiving[channel];
+}
+
+
+void ControlRC::setFilter(ChannelRC channel, ChannelFilter *filter) {
+  filters[channel] = filter;
+
+  if (filter != nullptr) {
+    filter->reset();
+  }
 }
 
 
 void ControlRC::setMapping(const int mapArray[], mapType mappingType) {
-  switch (mappingType) {
-    case (mapType::JOYSTICK):
-      joystickMap[0] = mapArray[0];
-      joystickMap[1] = mapArray[1];
-      
-      break;
-    case (mapType::THROTTLE):
-      throttleMap[0] = mapArray[0];
-      throttleMap[1] = mapArray[1];
+  if (mappingType == mapType::C_SWITCH) {
+    cSwitchMap[0] = mapArray[0];
+    cSwitchMap[1] = mapArray[1];
+    cSwitchMap[2] = mapArray[2];
+
+    return;
+  }
 
-      break;
-    case (mapType::SWITCH):
-      switchMap[0] = mapArray[0];
-      switchMap[1] = mapArray[1];
+  // Scale with 16 fractional bits, rounded to the nearest value
+  int32_t span = (int32_t)(mapArray[1] - mapArray[0]) * 65536L;
+  int32_t rangeRC = maxRC - minRC;
 
-      break;
-    case (mapType::C_SWITCH):
-      cSwitchMap[0] = mapArray[0];
-      cSwitchMap[1] = mapArray[1];
-      cSwitchMap[2] = mapArray[2];
+  mapLow[mappingType] = mapArray[0];
+  mapScale[mappingType] = (span + (span < 0 ? -rangeRC : rangeRC) / 2) / rangeRC;
+}
 
-      break;
-    case (mapType::KNOB):
-      knobMap[0] = mapArray[0];
-      knobMap[1] = mapArray[1];
 
-      break;
+int ControlRC::mapValue(int value, mapType mappingType) {
+  if (mappingType == mapType::C_SWITCH) {
+    if (value == minRC) {
+      return cSwitchMap[0];
+    } else if (value == midRC) {
+      return cSwitchMap[1];
+    } else {
+      return cSwitchMap[2];
+    }
   }
+
+  // Multiply and shift in place of map(), rounded to the nearest value
+  return mapLow[mappingType] + (int16_t)(((int32_t)(value - minRC) * mapScale[mappingType] + 0x8000) >> 16);
 }
 
 
 int ControlRC::getChannelValue(ChannelRC channel, bool mapChannel) {
   if (mapChannel) {
-    switch (channel) {
-      case (ChannelRC::LEFT_X):
-      case (ChannelRC::RIGHT_X):
-      case (ChannelRC::RIGHT_Y):
-        return map(*channelVal[channel], minRC, maxRC, joystickMap[0], joystickMap[1]);
-      case (ChannelRC::LEFT_Y):
-        return map(*channelVal[channel], minRC, maxRC, throttleMap[0], throttleMap[1]);
-      case (ChannelRC::SWA):
-      case (ChannelRC::SWB):
-      case (ChannelRC::SWD):
-        return map(*channelVal[channel], minRC, maxRC, switchMap[0], switchMap[1]);
-      case (ChannelRC::SWC):
-        if (*channelVal[channel] == minRC) {
-          return cSwitchMap[0];
-        } else if (*channelVal[channel] == ((minRC + maxRC) / 2)) {
-          return cSwitchMap[1];
-        } else {
-          return cSwitchMap[2];
-        }
-      case (ChannelRC::VRA):
-      case (ChannelRC::VRB):
-        return map(*channelVal[channel], minRC, maxRC, knobMap[0], knobMap[1]);
-    }
+    return mapValue(channels[channel], (mapType)channelMapType[channel]);
   } 
   
-  return *channelVal[channel];
+  return channels[channel];
 }
 
 
 int ControlRC::getThrottle(bool mapThrottle) {
   if (mapThrottle) {
-    return map(throttle, minRC, maxRC, throttleMap[0], throttleMap[1]);
+    return mapValue(channels[throttle], mapType::THROTTLE);
   } else {
-    return throttle;
+    return channels[throttle];
   }
 }
 
 
-int* ControlRC::getValueArray() {
-  return *channelVal;
+void ControlRC::getMappedChannels(int16_t out[]) {
+  for (uint8_t i = 0; i < numChannels; i++) {
+    out[i] = mapValue(channels[i], (mapType)channelMapType[i]);
+  }
 }
 
 
-int** ControlRC::getValuePointerArray() {
-  return channelVal;
+const int16_t* ControlRC::getValueArray() {
+  return channels;
 }
 
 
 void ControlRC::printChannels(bool isMapped) {
+#if !(defined(IBUS_UART_ISR) && defined(__AVR__))
   for (int i = 0; i < numChannels; i++) {
     Serial.print("Ch[");
     Serial.print(i + 1);
@@ -115,6 +312,9 @@ void ControlRC::printChannels(bool isMapped) {
     Serial.print(getChannelValue((ChannelRC)i, isMapped));
     Serial.print(i < numChannels - 1 ? "\t| " : "\n");
   }
+#else
+  (void)isMapped;
+#endif
 }
 
 
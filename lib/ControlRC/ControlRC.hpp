@@ -2,7 +2,8 @@
 #define TEST_RC
 
 #include <Arduino.h>
-#include <IBusBM.h>
+#include <IBusUart.hpp>
+#include "ChannelFilter.hpp"
 
 /*-----------------------------------------------------------------------------*/
 /** @file   ControlRC.hpp
@@ -30,6 +31,50 @@ const int numChannels = 10; // Number of channels on the FlySky FS-i6X controlle
 
 const int minRC = 1000; // Minimum value a channel can be
 const int maxRC = 2000; // Maximum value a channel can be
+const int midRC = (minRC + maxRC) / 2; // Value of a centered joystick
+
+
+/**
+ * @brief Compile-time channel mapping, resolved by ControlRC::get()
+ * 
+ * @note MapRC<low, high> maps linearly like setMapping() does for JOYSTICK, THROTTLE, SWITCH, and KNOB.
+ * MapRC<low, middle, high> picks a value for each position of a 3-position switch like C_SWITCH does.
+ * 
+ * @tparam Points Mapped values in the form {low, high} or {low, middle, high}
+ */
+template <int... Points>
+struct MapRC;
+
+
+template <int Low, int High>
+struct MapRC<Low, High> {
+  // Change in mapped value per raw unit with 16 fractional bits, rounded to the nearest value
+  static const int32_t scale = ((int32_t)(High - Low) * 65536L + ((High < Low ? -1 : 1) * (maxRC - minRC) / 2)) / (maxRC - minRC);
+
+  /**
+   * @brief Maps a raw channel value with a single multiply and shift
+   * 
+   * @param value Raw channel value
+   * @return Mapped value
+   */
+  static inline int apply(int value) {
+    return Low + (int16_t)(((int32_t)(value - minRC) * scale + 0x8000) >> 16);
+  }
+};
+
+
+template <int Low, int Middle, int High>
+struct MapRC<Low, Middle, High> {
+  /**
+   * @brief Maps the raw value of a 3-position switch
+   * 
+   * @param value Raw channel value
+   * @return Mapped value of the switch position
+   */
+  static inline int apply(int value) {
+    return value == minRC ? Low : value == midRC ? Middle : High;
+  }
+};
 
 
 /**
@@ -37,42 +82,67 @@ const int maxRC = 2000; // Maximum value a channel can be
  */
 class ControlRC {
   private: 
-    int left_x, left_y;
-    int right_x, right_y;
-    int swa, swb, swc, swd;
-    int vra, vrb;
-
-    int& throttle = left_y;         // The left y-axis has the throttle (Doesn't spring back to the middle)
-    int* channelVal[numChannels]= { // Default pointers to use
-      &right_x,
-      &right_y,
-      &left_y,
-      &left_x,
-      &swa,
-      &swd,
-      &swb,
-      &swc,
-      &vra, 
-      &vrb
-    };
+    static const uint8_t numMapTypes = 5;             // Number of mapping types
+    static const uint8_t channelMapType[numChannels]; // Mapping type used by each channel
+    static const ChannelRC throttle = ChannelRC::LEFT_Y; // The left y-axis has the throttle (Doesn't spring back to the middle)
+    static const int16_t zeroTolerance = 50;          // Distance from center or minimum still counted as zeroed
 
-    int joystickMap[2];
-    int throttleMap[2];
-    int switchMap[2];
-    int cSwitchMap[3];
-    int knobMap[2];
+    int16_t channels[numChannels]; // Raw channel values, indexed by ChannelRC
+    ChannelFilter *filters[numChannels]; // Filter applied to each channel as frames arrive (nullptr for none)
 
-    bool joysticksCentered = false; // Condition for if the joysticks are centered 
+    int16_t mapLow[numMapTypes];   // Mapped value at minRC for each mapping type
+    int32_t mapScale[numMapTypes]; // Change in mapped value per raw unit for each mapping type (16 fractional bits)
+    int16_t cSwitchMap[3];         // Mapped values of the low, middle, and high SWC positions
+
+    bool joysticksCentered = false; // Condition for if the joysticks are centered and the throttle is down
     bool switchesOff = false;       // Condition for if the switches are off 
     bool knobsOff = false;          // Condition for if the knobs are off 
-    bool isZeroed = false;          // Condition for if the receiver has been zeroed
+    bool isZeroed = false;          // Condition for if the receiver has been zeroed (Joysticks centered and switches off)
 
     bool isReceiving[numChannels];  // Array of conditions for which channels are receiving
 
-    IBusBM iBus; // iBus object for control over communications
+    uint8_t lastSequence = 0; // Sequence number of the last iBus frame read from the decoder
+
+    uint16_t frameChanges = 0;      // Bitmask of channels changed by the latest frame or failsafe, bit n is ChannelRC n
+    uint16_t pendingChanges = 0;    // Bitmask of channels changed since takeChanges() was last called
+    uint8_t switchPositions[numChannels]; // Last position of each switch channel (0 low, 1 middle, 2 high)
+
+    uint32_t lastFrameTime = 0;     // micros() when the last frame was read
+    uint32_t signalTimeout = defaultSignalTimeout; // Time without a frame before the failsafe is raised in microseconds
+    bool failsafe = true;           // Condition for if the signal is lost (True until the first frame)
+    bool armed = false;             // Condition for if the receiver has been zeroed since the signal was last lost
+
+
+    /**
+     * @brief Sets a channel value and marks it as changed if it differs
+     * 
+     * @param index Channel to set
+     * @param value New channel value
+     */
+    void setChannel(uint8_t index, int16_t value);
+
+
+    /**
+     * @brief Calls the switch handlers for every switch that moved in the latest frame
+     */
+    void dispatchSwitchEdges();
+
+
+    /**
+     * @brief Raises the failsafe, disarms, and sets every channel to its zeroed value
+     */
+    void enterFailsafe();
+
+
+    /**
+     * @brief Updates the zeroed conditions from the current channel values
+     */
+    void updateZeroed();
 
   public:
     static const unsigned long iBusBaudrate = 115200; // Serial monitor baudrate for the iBus 
+    static const uint8_t maxSwitchHandlers = 8;         // Size of the switch handler table
+    static const uint32_t defaultSignalTimeout = 100000; // Default time without a frame before the failsafe in microseconds (About 14 frames)
 
     /**
      * @brief Type of mapping for setter method
@@ -86,6 +156,37 @@ class ControlRC {
     };
 
 
+    /**
+     * @brief Direction a switch moved
+     */
+    enum SwitchEdge {
+      FALLING = 0, // Towards the low position
+      RISING       // Towards the high position
+    };
+
+
+    /**
+     * @brief Function called when a switch moves
+     * 
+     * @param channel Switch that moved
+     * @param position New position of the switch (0 low, 1 middle for SWC, 2 high)
+     * @param edge Direction the switch moved
+     */
+    typedef void (*SwitchHandler)(ChannelRC channel, uint8_t position, SwitchEdge edge);
+
+  private:
+    /**
+     * @brief Entry of the switch handler table
+     */
+    struct SwitchHandlerEntry {
+      ChannelRC channel;
+      SwitchHandler handler;
+    };
+
+    SwitchHandlerEntry switchHandlers[maxSwitchHandlers]; // Registered switch handlers, called in order
+    uint8_t numSwitchHandlers = 0;                        // Number of registered switch handlers
+
+  public:
     /**
      * @brief Defines a ControlRC object
      */
@@ -93,20 +194,163 @@ class ControlRC {
 
 
     /**
-     * @brief Updates the values in the channels array
+     * @brief Begins iBus communication
+     */
+    void begin();
+
+
+    /**
+     * @brief Updates the values in the channels array if a new iBus frame has arrived
+     * 
+     * @note Also raises the failsafe once no frame has arrived for the signal timeout, so the failsafe is
+     * raised at most the signal timeout plus the time between update() calls after the last frame
+     * 
+     * @return Condition for if a new frame was read
+     */
+    bool update();
+
+
+    /**
+     * @brief Gets the channels changed by the latest frame or failsafe
+     * 
+     * @return Bitmask of changed channels, bit n is ChannelRC n
+     */
+    uint16_t getChangedMask();
+
+
+    /**
+     * @brief Gets and clears the channels changed since this was last called
+     * 
+     * @note Lets a task that runs slower than update() see every change
+     * 
+     * @return Bitmask of changed channels, bit n is ChannelRC n
+     */
+    uint16_t takeChanges();
+
+
+    /**
+     * @brief Checks if a channel changed in the latest frame or failsafe
+     * 
+     * @param channel Channel to check
+     * @return Condition for if the channel changed
+     */
+    bool hasChanged(ChannelRC channel);
+
+
+    /**
+     * @brief Adds a function to call whenever a switch channel (SWA to SWD) moves
+     * 
+     * @note Called from update(), so keep handlers short. Switches start in the low position, so a switch 
+     * that is already on when the first frame arrives gives a rising edge.
+     * 
+     * @param channel Switch to watch
+     * @param handler Function to call
+     * @return Condition for if the handler was added (False if the table is full or the channel isn't a switch)
+     */
+    bool onSwitch(ChannelRC channel, SwitchHandler handler);
+
+
+    /**
+     * @brief Gets the position of a switch channel
+     * 
+     * @param channel Switch to get the position of
+     * @return Position of the switch (0 low, 1 middle for SWC, 2 high)
+     */
+    uint8_t getSwitchPosition(ChannelRC channel);
+
+
+    /**
+     * @brief Sets the time without a frame before the failsafe is raised
+     * 
+     * @param timeoutMicros Signal timeout in microseconds
+     */
+    void setSignalTimeout(uint32_t timeoutMicros);
+
+
+    /**
+     * @brief Gets the time since the last frame was read
+     * 
+     * @return Frame age in microseconds
+     */
+    uint32_t getFrameAge();
+
+
+    /**
+     * @brief Checks if the signal is lost
+     * 
+     * @note While in failsafe the joysticks read centered and the throttle, switches, and knobs read their minimum
+     * 
+     * @return Condition for if the failsafe is raised
+     */
+    bool isFailsafe();
+
+
+    /**
+     * @brief Checks if the receiver is armed
+     * 
+     * @note Arms once a frame arrives with the joysticks centered, the throttle down, and the switches off.
+     * Stays armed until the failsafe is raised or disarm() is called.
+     * 
+     * @return Condition for if outputs may be driven
+     */
+    bool isArmed();
+
+
+    /**
+     * @brief Disarms the receiver until the controls are zeroed again
+     */
+    void disarm();
+
+
+    /**
+     * @brief Checks if the controls are zeroed in the latest frame
+     * 
+     * @return Condition for if the joysticks are centered, the throttle is down, and the switches are off
+     */
+    bool getZeroed();
+
+
+    /**
+     * @brief Checks if a channel had a valid value in the latest frame
+     * 
+     * @param channel Channel to check
+     * @return Condition for if the channel is receiving
+     */
+    bool getReceiving(ChannelRC channel);
+
+
+    /**
+     * @brief Sets the filter applied to a channel as new frames arrive
+     * 
+     * @note The filter keeps its own history, so give every channel its own ChannelFilter
+     * 
+     * @param channel Channel to filter
+     * @param filter Filter to apply (nullptr for none, the default)
      */
-    void update();
+    void setFilter(ChannelRC channel, ChannelFilter *filter);
 
 
     /**
      * @brief Sets the mapping array given the type of mapping to set
      * 
+     * @note The scale factor for the mapping type is computed here so mapping a channel never divides
+     * 
      * @param mapArray Array to use to set the mapping values
      * @param mappingType Type of mapping to set
      */
     void setMapping(const int mapArray[], mapType mappingType);
 
 
+    /**
+     * @brief Maps a raw channel value using a mapping type
+     * 
+     * @param value Raw channel value
+     * @param mappingType Type of mapping to use
+     * @return Mapped value
+     */
+    int mapValue(int value, mapType mappingType);
+
+
     /**
      * @brief Get the value of a given channel
      * 
@@ -127,7 +371,22 @@ class ControlRC {
      */
     template <class T>
     inline T getChannelValue(ChannelRC channel, T (*mapFunction)(int)) {
-      return mapFunction(*channelVal[channel]);
+      return mapFunction(channels[channel]);
+    }
+
+
+    /**
+     * @brief Gets the value of a channel mapped at compile time
+     * 
+     * @note Example: rc.get<ChannelRC::SWC, MapRC<0, 90, 180>>()
+     * 
+     * @tparam Channel Channel to get the value from
+     * @tparam Mapping MapRC type to map the value with
+     * @return Mapped value from the channel
+     */
+    template <ChannelRC Channel, class Mapping>
+    inline int get() {
+      return Mapping::apply(channels[Channel]);
     }
 
 
@@ -143,24 +402,26 @@ class ControlRC {
 
 
     /**
-     * @brief Gets all channel values as an array
+     * @brief Maps every channel in a single pass
      * 
-     * @return Array of unmapped channel values 
+     * @param out Array of numChannels values to fill with the mapped channel values, indexed by ChannelRC
      */
-    int* getValueArray();
+    void getMappedChannels(int16_t out[]);
 
 
     /**
-     * @brief Gets all the channel value pointers as an array
+     * @brief Gets all channel values as an array
      * 
-     * @return Array of channel value pointers
+     * @return Array of numChannels unmapped channel values, indexed by ChannelRC
      */
-    int** getValuePointerArray();
+    const int16_t* getValueArray();
 
 
     /**
      * @brief Prints the value of each channel
      * 
+     * @note Prints nothing with IBUS_UART_ISR, where the UART interrupts don't belong to Serial
+     * 
      * @param isMapped Condition to map the values when printing
      */
     void printChannels(bool isMapped = false);
@@ -0,0 +1,109 @@
+#include "ControlTimer.hpp"
+
+uint16_t ControlTimer::periodMillis = 0;
+volatile uint16_t ControlTimer::countdown = 0;
+volatile uint8_t ControlTimer::pending = 0;
+volatile uint16_t ControlTimer::missed = 0;
+uint32_t ControlTimer::nextTick = 0;
+
+
+void ControlTimer::handleInterrupt() {
+  if (--countdown != 0) {
+    return;
+  }
+
+  countdown = periodMillis;
+  if (pending) {
+    missed++;
+  } else {
+    pending = 1;
+  }
+}
+
+
+#ifdef __AVR__
+
+void ControlTimer::begin(uint16_t period) {
+  noInterrupts();
+  periodMillis = countdown = period ? period : 1;
+  pending = 0;
+
+  // CTC mode with a 1 ms compare match
+  TCCR2A = _BV(WGM21);
+  TCCR2B = _BV(CS22); // Prescaler 64
+  OCR2A = F_CPU / 64 / 1000 - 1;
+  TCNT2 = 0;
+  TIFR2 = _BV(OCF2A);
+  TIMSK2 = _BV(OCIE2A);
+  interrupts();
+}
+
+
+void ControlTimer::end() {
+  TIMSK2 &= ~_BV(OCIE2A);
+}
+
+
+bool ControlTimer::takeTick() {
+  if (!pending) {
+    return false;
+  }
+
+  pending = 0; // Single byte write, no need to disable interrupts
+  return true;
+}
+
+
+ISR(TIMER2_COMPA_vect) {
+  ControlTimer::handleInterrupt();
+}
+
+#else
+
+void ControlTimer::begin(uint16_t period) {
+  periodMillis = countdown = period ? period : 1;
+  pending = 0;
+  nextTick = micros() + getPeriodMicros();
+}
+
+
+void ControlTimer::end() {
+  periodMillis = 0;
+}
+
+
+bool ControlTimer::takeTick() {
+  if (periodMillis == 0) {
+    return false;
+  }
+
+  // Releases the ticks the interrupt would have released since the last call
+  while ((int32_t)(micros() - nextTick) >= 0) {
+    nextTick += getPeriodMicros();
+    countdown = 1;
+    handleInterrupt();
+  }
+
+  if (!pending) {
+    return false;
+  }
+
+  pending = 0;
+  return true;
+}
+
+#endif
+
+
+uint16_t ControlTimer::getMissed() {
+  noInterrupts();
+  uint16_t count = missed;
+  interrupts();
+
+  return count;
+}
+
+
+uint32_t ControlTimer::getPeriodMicros() {
+  return (uint32_t)periodMillis * 1000;
+}
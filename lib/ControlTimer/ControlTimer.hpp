@@ -0,0 +1,75 @@
+#ifndef CONTROL_TIMER
+#define CONTROL_TIMER
+
+#include <Arduino.h>
+
+/*-----------------------------------------------------------------------------*/
+/** @file   ControlTimer.hpp
+ * @brief   Header for ControlTimer class (hardware timed fixed-rate control tick)
+*//*---------------------------------------------------------------------------*/
+
+
+/**
+ * @brief Class used to release control steps at an exact fixed period
+ * 
+ * @note On AVR boards Timer2 fires a compare interrupt every 1 ms (Prescaler 64, OCR2A 249 at 16 MHz),
+ * and a tick is released every periodMillis interrupts. The period is an exact number of 
+ * milliseconds, so controllers can use a constant, precomputed dt. Timer2 is then unavailable 
+ * for tone() and analogWrite() on pins 3 and 11. On the host, ticks are released from micros().
+ */
+class ControlTimer {
+  private:
+    static uint16_t periodMillis;        // Time between ticks in milliseconds
+    static volatile uint16_t countdown;  // Milliseconds left until the next tick
+    static volatile uint8_t pending;     // Ticks released but not taken yet
+    static volatile uint16_t missed;     // Ticks released while another was still pending
+    static uint32_t nextTick;            // Time of the next tick in microseconds (Host only)
+
+  public:
+    /**
+     * @brief Starts releasing ticks
+     * 
+     * @param period Time between ticks in milliseconds
+     */
+    static void begin(uint16_t period);
+
+
+    /**
+     * @brief Stops releasing ticks
+     */
+    static void end();
+
+
+    /**
+     * @brief Takes a tick if one has been released
+     * 
+     * @return Condition for if a control step should run now
+     */
+    static bool takeTick();
+
+
+    /**
+     * @brief Gets the number of ticks that were released while the previous one hadn't been taken
+     * 
+     * @note A non-zero count means the control step takes longer than the period
+     * 
+     * @return Number of late ticks
+     */
+    static uint16_t getMissed();
+
+
+    /**
+     * @brief Gets the time between ticks in microseconds
+     * 
+     * @return Tick period in microseconds
+     */
+    static uint32_t getPeriodMicros();
+
+
+    /**
+     * @brief Counts down one millisecond and releases a tick when the period has passed (Called from the interrupt)
+     */
+    static void handleInterrupt();
+};
+
+#endif // CONTROL_TIMER
@@ -0,0 +1,143 @@
+#include "EscPwm.hpp"
+
+const uint16_t EscPwm::minRate;
+const uint16_t EscPwm::maxRate;
+
+uint8_t EscPwm::ticksPerMicro = 2;
+uint16_t EscPwm::minPulse = 1000;
+uint16_t EscPwm::maxPulse = 2000;
+uint16_t EscPwm::topTicks = 0;
+uint16_t EscPwm::pulseTicks[2] = {0, 0};
+
+
+/* ----------------------------- Timer1 ---------------------------- */
+
+#ifdef __AVR__
+
+void EscPwm::begin(uint16_t rate, uint16_t minMicros, uint16_t maxMicros) {
+  rate = constrain(rate, minRate, maxRate);
+  minPulse = minMicros;
+  maxPulse = maxMicros;
+
+  // Prescaler 1 if a period fits in 16 bits, otherwise 8
+  bool fastClock = F_CPU / rate <= 65536UL;
+  ticksPerMicro = F_CPU / (fastClock ? 1 : 8) / 1000000UL;
+  topTicks = F_CPU / (fastClock ? 1 : 8) / rate - 1;
+
+  noInterrupts();
+  // Fast PWM with ICR1 as TOP (Mode 14), outputs off until attached
+  TCCR1A = _BV(WGM11);
+  TCCR1B = _BV(WGM13) | _BV(WGM12) | (fastClock ? _BV(CS10) : _BV(CS11));
+  ICR1 = topTicks;
+  TCNT1 = 0;
+  interrupts();
+}
+
+
+void EscPwm::attach(Channel channel) {
+  // Zero throttle is loaded before the pin starts pulsing
+  pulseTicks[channel] = 0;
+  writeMicroseconds(channel, minPulse);
+
+  if (channel == OUTPUT_A) {
+    pinMode(9, OUTPUT);
+    TCCR1A |= _BV(COM1A1);
+  } else {
+    pinMode(10, OUTPUT);
+    TCCR1A |= _BV(COM1B1);
+  }
+}
+
+
+void EscPwm::detach(Channel channel) {
+  if (channel == OUTPUT_A) {
+    TCCR1A &= ~_BV(COM1A1);
+    digitalWrite(9, LOW);
+  } else {
+    TCCR1A &= ~_BV(COM1B1);
+    digitalWrite(10, LOW);
+  }
+}
+
+
+void EscPwm::writeTicks(Channel channel, uint16_t ticks) {
+  // OCR1x is double buffered in fast PWM, so a new width starts on the next period without a glitch
+  noInterrupts();
+  if (channel == OUTPUT_A) {
+    OCR1A = ticks - 1;
+  } else {
+    OCR1B = ticks - 1;
+  }
+  interrupts();
+}
+
+#else
+
+void EscPwm::begin(uint16_t rate, uint16_t minMicros, uint16_t maxMicros) {
+  rate = constrain(rate, minRate, maxRate);
+  minPulse = minMicros;
+  maxPulse = maxMicros;
+
+  bool fastClock = F_CPU / rate <= 65536UL;
+  ticksPerMicro = F_CPU / (fastClock ? 1 : 8) / 1000000UL;
+  topTicks = F_CPU / (fastClock ? 1 : 8) / rate - 1;
+}
+
+
+void EscPwm::attach(Channel channel) {
+  pulseTicks[channel] = 0;
+  writeMicroseconds(channel, minPulse);
+}
+
+
+void EscPwm::detach(Channel channel) {
+  pulseTicks[channel] = 0;
+}
+
+
+void EscPwm::writeTicks(Channel, uint16_t) {}
+
+#endif
+
+/* ----------------------------------------------------------------- */
+
+
+
+/* ---------------------------- Outputs ---------------------------- */
+
+void EscPwm::writeMicroseconds(Channel channel, uint16_t pulseMicros) {
+  pulseMicros = constrain(pulseMicros, minPulse, maxPulse);
+  uint16_t ticks = pulseMicros * ticksPerMicro;
+
+  if (ticks != pulseTicks[channel]) {
+    pulseTicks[channel] = ticks;
+    writeTicks(channel, ticks);
+  }
+}
+
+
+void EscPwm::writeThrottle(Channel channel, Fixed16 throttle) {
+  throttle = constrain(throttle, Fixed16(0), Fixed16(1));
+
+  // Every timer count between the minimum and maximum pulse widths is reachable
+  uint16_t minTicks = minPulse * ticksPerMicro;
+  uint16_t spanTicks = (maxPulse - minPulse) * ticksPerMicro;
+  uint16_t ticks = minTicks + (uint16_t)(((int32_t)spanTicks * throttle.getRaw() + 0x8000L) >> 16);
+
+  if (ticks != pulseTicks[channel]) {
+    pulseTicks[channel] = ticks;
+    writeTicks(channel, ticks);
+  }
+}
+
+
+uint16_t EscPwm::readMicroseconds(Channel channel) {
+  return (pulseTicks[channel] + ticksPerMicro / 2) / ticksPerMicro;
+}
+
+
+uint8_t EscPwm::getTicksPerMicro() {
+  return ticksPerMicro;
+}
+
+/* ----------------------------------------------------------------- */
@@ -0,0 +1,117 @@
+#ifndef ESC_PWM
+#define ESC_PWM
+
+#include <Arduino.h>
+#include <FixedPoint.hpp>
+
+/*-----------------------------------------------------------------------------*/
+/** @file   EscPwm.hpp
+ * @brief   Header for EscPwm class (ESC pulses generated by Timer1 hardware compare)
+*//*---------------------------------------------------------------------------*/
+
+
+/**
+ * @brief Class used to drive up to two ESCs with pulses generated directly by Timer1
+ * 
+ * @note Timer1 runs in fast PWM mode with ICR1 as TOP, so the pulses come from the compare hardware 
+ * with no interrupts and no jitter. Below about 245 Hz the prescaler is 8 (0.5 us steps at 16 MHz), 
+ * otherwise it is 1 (62.5 ns steps). Timer1 is then unavailable for the Servo library and analogWrite() 
+ * on pins 9 and 10. On the host, the pulse widths are only recorded.
+ */
+class EscPwm {
+  public:
+    /**
+     * @brief Timer1 compare outputs
+     */
+    enum Channel {
+      OUTPUT_A = 0, // OC1A, pin 9
+      OUTPUT_B      // OC1B, pin 10
+    };
+
+    static const uint16_t minRate = 50;  // Slowest update rate in hertz
+    static const uint16_t maxRate = 400; // Fastest update rate in hertz
+
+  private:
+    static uint8_t ticksPerMicro;  // Timer counts per microsecond
+    static uint16_t minPulse;      // Pulse width at zero throttle in microseconds
+    static uint16_t maxPulse;      // Pulse width at full throttle in microseconds
+    static uint16_t topTicks;      // Timer counts per period minus one (ICR1)
+    static uint16_t pulseTicks[2]; // Pulse width of each output in timer counts
+
+    /**
+     * @brief Writes the compare register of an output
+     * 
+     * @param channel Output to write
+     * @param ticks Pulse width in timer counts
+     */
+    static void writeTicks(Channel channel, uint16_t ticks);
+
+  public:
+    /**
+     * @brief Starts Timer1 at an update rate
+     * 
+     * @note Outputs stay off until attach() is called
+     * 
+     * @param rate Pulses per second, kept between 50 and 400 (Default 50)
+     * @param minMicros Pulse width at zero throttle in microseconds (Default 1000)
+     * @param maxMicros Pulse width at full throttle in microseconds (Default 2000)
+     */
+    static void begin(uint16_t rate = minRate, uint16_t minMicros = 1000, uint16_t maxMicros = 2000);
+
+
+    /**
+     * @brief Starts the pulses on an output at zero throttle
+     * 
+     * @param channel Output to start
+     */
+    static void attach(Channel channel);
+
+
+    /**
+     * @brief Stops the pulses on an output and holds the pin low
+     * 
+     * @param channel Output to stop
+     */
+    static void detach(Channel channel);
+
+
+    /**
+     * @brief Sets the pulse width of an output
+     * 
+     * @note The compare register is only written when the pulse width changes
+     * 
+     * @param channel Output to set
+     * @param pulseMicros Pulse width in microseconds, kept between the minimum and maximum pulse widths
+     */
+    static void writeMicroseconds(Channel channel, uint16_t pulseMicros);
+
+
+    /**
+     * @brief Sets the throttle of an output with the full timer resolution
+     * 
+     * @note The compare register is only written when the pulse width changes
+     * 
+     * @param channel Output to set
+     * @param throttle Throttle from 0 to 1 (Kept in that range)
+     */
+    static void writeThrottle(Channel channel, Fixed16 throttle);
+
+
+    /**
+     * @brief Gets the pulse width of an output
+     * 
+     * @param channel Output to get
+     * @return Pulse width in microseconds
+     */
+    static uint16_t readMicroseconds(Channel channel);
+
+
+    /**
+     * @brief Gets the number of timer counts per microsecond
+     * 
+     * @return Counts per microsecond (2 below about 245 Hz and 16 above at 16 MHz)
+     */
+    static uint8_t getTicksPerMicro();
+};
+
+#endif // ESC_PWM
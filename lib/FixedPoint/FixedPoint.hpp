@@ -0,0 +1,294 @@
+#ifndef FIXED_POINT
+#define FIXED_POINT
+
+#include <stdint.h>
+
+// The AVR has no 64 bit hardware, so operator* and operator/ use the 32 bit narrowMultiply() and 
+// narrowDivide() there (Define FIXED_POINT_NARROW_MATH to use them on another target too)
+#if defined(__AVR__) && !defined(FIXED_POINT_NARROW_MATH)
+#define FIXED_POINT_NARROW_MATH
+#endif
+
+/*-----------------------------------------------------------------------------*/
+/** @file    FixedPoint.hpp
+  * @brief   Header for FixedPoint class (saturating Qm.n fixed-point numbers)
+*//*---------------------------------------------------------------------------*/
+
+
+/**
+ * @brief Signed fixed-point number stored in 32 bits with saturating arithmetic
+ *
+ * @note Results that don't fit are clamped to the largest or smallest value instead of wrapping
+ *
+ * @tparam FracBits Number of fractional bits (Q(32 - FracBits).FracBits, sign bit included)
+ */
+template <uint8_t FracBits>
+class FixedPoint {
+  static_assert(FracBits > 0 && FracBits < 31, "FixedPoint needs between 1 and 30 fractional bits");
+
+  private:
+    static const int32_t rawMax = 0x7FFFFFFFL; // Largest raw value
+    static const int32_t rawMin = -rawMax - 1;  // Smallest raw value
+
+    int32_t raw; // Underlying value scaled by 2^FracBits
+
+    /**
+     * @brief Clamps a wide intermediate result into the 32 bit range
+     *
+     * @param value Intermediate result
+     * @return Saturated 32 bit value
+     */
+    static inline int32_t saturate(int64_t value) {
+      return value > rawMax ? rawMax : value < rawMin ? rawMin : (int32_t)value;
+    }
+
+
+    /**
+     * @brief Multiplies two raw values into a 64 bit product held in two words
+     *
+     * @note Built from four 16x16->32 bit multiplies, which the AVR does with its hardware multiplier, 
+     * so no 64 bit library routine (Multiply, shift or compare) is called
+     *
+     * @param a First raw value
+     * @param b Second raw value
+     * @param high Set to the upper 32 bits of the product
+     * @param low Set to the lower 32 bits of the product
+     */
+    static inline void wideMultiply(int32_t a, int32_t b, int32_t &high, uint32_t &low) {
+      uint32_t magnitudeA = a < 0 ? 0u - (uint32_t)a : (uint32_t)a;
+      uint32_t magnitudeB = b < 0 ? 0u - (uint32_t)b : (uint32_t)b;
+
+      uint16_t a0 = magnitudeA, a1 = magnitudeA >> 16;
+      uint16_t b0 = magnitudeB, b1 = magnitudeB >> 16;
+      uint32_t p00 = (uint32_t)a0 * b0;
+      uint32_t p01 = (uint32_t)a0 * b1;
+      uint32_t p10 = (uint32_t)a1 * b0;
+      uint32_t p11 = (uint32_t)a1 * b1;
+
+      // Sum of the three terms at bit 16, at most 18 bits wide
+      uint32_t middle = (p00 >> 16) + (uint16_t)p01 + (uint16_t)p10;
+      uint32_t upper = p11 + (p01 >> 16) + (p10 >> 16) + (middle >> 16);
+      low = (middle << 16) | (uint16_t)p00;
+
+      // Two's complement of both words when the signs differ
+      if ((a ^ b) < 0) {
+        low = 0u - low;
+        upper = ~upper + (low == 0);
+      }
+
+      high = (int32_t)upper;
+    }
+
+  public:
+    static const uint8_t fractionalBits = FracBits;    // Number of fractional bits
+    static const int32_t one = (int32_t)1 << FracBits; // Raw value of 1.0
+
+
+    /**
+     * @brief Defines a fixed-point number with a value of 0
+     */
+    FixedPoint() : raw(0) {}
+
+
+    /**
+     * @brief Defines a fixed-point number from an integer
+     *
+     * @param value Integer value
+     */
+    FixedPoint(int value) : raw(saturate((int64_t)value * one)) {}
+
+
+    /**
+     * @brief Defines a fixed-point number from a long integer
+     *
+     * @param value Integer value
+     */
+    FixedPoint(long value) : raw(saturate((int64_t)value * one)) {}
+
+
+    /**
+     * @brief Defines a fixed-point number from a floating-point value
+     *
+     * @note Uses floating-point math, so keep this out of hot paths (constants, setup, etc.)
+     *
+     * @param value Floating-point value
+     */
+    FixedPoint(double value) {
+      double scaled = value * one;
+      scaled += scaled < 0 ? -0.5 : 0.5;
+      raw = scaled >= (double)rawMax ? rawMax : scaled <= (double)rawMin ? rawMin : (int32_t)scaled;
+    }
+
+
+    /**
+     * @brief Creates a fixed-point number directly from its raw representation
+     *
+     * @param value Raw value scaled by 2^FracBits
+     * @return Fixed-point number
+     */
+    static inline FixedPoint fromRaw(int32_t value) {
+      FixedPoint result;
+      result.raw = value;
+      return result;
+    }
+
+
+    /**
+     * @brief Largest value that can be stored
+     */
+    static inline FixedPoint maxValue() { return fromRaw(rawMax); }
+
+
+    /**
+     * @brief Smallest value that can be stored
+     */
+    static inline FixedPoint minValue() { return fromRaw(rawMin); }
+
+
+    /**
+     * @brief Gets the raw representation of the number
+     *
+     * @return Raw value scaled by 2^FracBits
+     */
+    inline int32_t getRaw() const { return raw; }
+
+
+    /**
+     * @brief Gets the integer part of the number (Rounded towards negative infinity)
+     *
+     * @return Integer value
+     */
+    inline int32_t toInt() const { return raw >> FracBits; }
+
+
+    /**
+     * @brief Converts the number to a floating-point value (Used for display)
+     */
+    explicit inline operator double() const { return (double)raw / one; }
+
+
+    /**
+     * @brief Multiplies with 32 bit math only (What operator* uses on AVR)
+     *
+     * @note Rounds to nearest and saturates exactly like the 64 bit version
+     */
+    static inline FixedPoint narrowMultiply(FixedPoint a, FixedPoint b) {
+      int32_t high;
+      uint32_t low;
+      wideMultiply(a.raw, b.raw, high, low);
+
+      // Rounds to nearest by adding half of the last kept bit, carrying into the upper word
+      uint32_t rounded = low + ((uint32_t)1 << (FracBits - 1));
+      high += rounded < low;
+
+      // The result is the bits FracBits up, which only fit if every bit above them copies its sign
+      int32_t result = (int32_t)(((uint32_t)high << (32 - FracBits)) | (rounded >> FracBits));
+      if ((high >> (FracBits - 1)) != (result < 0 ? -1 : 0)) {
+        return high < 0 ? minValue() : maxValue();
+      }
+      return fromRaw(result);
+    }
+
+
+    /**
+     * @brief Divides with 32 bit math only (What operator/ uses on AVR)
+     *
+     * @note Rounds towards zero and saturates exactly like the 64 bit version
+     */
+    static inline FixedPoint narrowDivide(FixedPoint a, FixedPoint b) {
+      if (b.raw == 0) {
+        return a.raw < 0 ? minValue() : maxValue();
+      }
+
+      // Integer part with one 32 bit divide, then the fraction one bit at a time (Rounds towards zero)
+      bool negative = (a.raw ^ b.raw) < 0;
+      uint32_t dividend = a.raw < 0 ? 0u - (uint32_t)a.raw : (uint32_t)a.raw;
+      uint32_t divisor = b.raw < 0 ? 0u - (uint32_t)b.raw : (uint32_t)b.raw;
+      uint32_t quotient = dividend / divisor;
+      uint32_t remainder = dividend % divisor;
+
+      if (quotient > ((uint32_t)rawMax >> FracBits)) {
+        return negative ? minValue() : maxValue();
+      }
+
+      // The remainder is below the divisor (At most 2^31), so doubling it can't overflow
+      for (uint8_t i = 0; i < FracBits; i++) {
+        quotient <<= 1;
+        remainder <<= 1;
+        if (remainder >= divisor) {
+          remainder -= divisor;
+          quotient |= 1;
+        }
+      }
+
+      return fromRaw(negative ? (int32_t)(0u - quotient) : (int32_t)quotient);
+    }
+
+
+    /* ------------------------ Arithmetic ------------------------- */
+
+    friend inline FixedPoint operator+(FixedPoint a, FixedPoint b) {
+      int32_t result;
+      if (__builtin_add_overflow(a.raw, b.raw, &result)) {
+        result = a.raw < 0 ? rawMin : rawMax;
+      }
+      return fromRaw(result);
+    }
+
+    friend inline FixedPoint operator-(FixedPoint a, FixedPoint b) {
+      int32_t result;
+      if (__builtin_sub_overflow(a.raw, b.raw, &result)) {
+        result = a.raw < 0 ? rawMin : rawMax;
+      }
+      return fromRaw(result);
+    }
+
+    friend inline FixedPoint operator*(FixedPoint a, FixedPoint b) {
+#ifdef FIXED_POINT_NARROW_MATH
+      return narrowMultiply(a, b);
+#else
+      int64_t product = (int64_t)a.raw * b.raw;
+      return fromRaw(saturate((product + ((int64_t)1 << (FracBits - 1))) >> FracBits));
+#endif
+    }
+
+    friend inline FixedPoint operator/(FixedPoint a, FixedPoint b) {
+#ifdef FIXED_POINT_NARROW_MATH
+      return narrowDivide(a, b);
+#else
+      if (b.raw == 0) {
+        return a.raw < 0 ? minValue() : maxValue();
+      }
+      return fromRaw(saturate(((int64_t)a.raw * one) / b.raw));
+#endif
+    }
+
+    inline FixedPoint operator-() const {
+      return fromRaw(raw == rawMin ? rawMax : -raw);
+    }
+
+    inline FixedPoint& operator+=(FixedPoint other) { return *this = *this + other; }
+    inline FixedPoint& operator-=(FixedPoint other) { return *this = *this - other; }
+    inline FixedPoint& operator*=(FixedPoint other) { return *this = *this * other; }
+    inline FixedPoint& operator/=(FixedPoint other) { return *this = *this / other; }
+
+
+    /* ------------------------ Comparison ------------------------- */
+
+    friend inline bool operator==(FixedPoint a, FixedPoint b) { return a.raw == b.raw; }
+    friend inline bool operator!=(FixedPoint a, FixedPoint b) { return a.raw != b.raw; }
+    friend inline bool operator<(FixedPoint a, FixedPoint b)  { return a.raw < b.raw; }
+    friend inline bool operator<=(FixedPoint a, FixedPoint b) { return a.raw <= b.raw; }
+    friend inline bool operator>(FixedPoint a, FixedPoint b)  { return a.raw > b.raw; }
+    friend inline bool operator>=(FixedPoint a, FixedPoint b) { return a.raw >= b.raw; }
+};
+
+template <uint8_t FracBits> const int32_t FixedPoint<FracBits>::rawMax;
+template <uint8_t FracBits> const int32_t FixedPoint<FracBits>::rawMin;
+template <uint8_t FracBits> const uint8_t FixedPoint<FracBits>::fractionalBits;
+template <uint8_t FracBits> const int32_t FixedPoint<FracBits>::one;
+
+
+typedef FixedPoint<16> Fixed16; // Q16.16 number, the default fixed-point backend
+
+#endif // FIXED_POINT
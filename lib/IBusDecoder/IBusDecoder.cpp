@@ -0,0 +1,98 @@
+#include "IBusDecoder.hpp"
+
+IBusDecoder::IBusDecoder() {
+  for (uint8_t i = 0; i < maxChannels; i++) {
+    channels[0][i] = channels[1][i] = 0;
+  }
+}
+
+
+void IBusDecoder::handleByte(uint8_t data) {
+  switch (position) {
+    case 0: // Length byte
+      if (data != frameLength) {
+        return;
+      }
+      sum = data;
+      position = 1;
+      return;
+
+    case 1: // Command byte
+      if (data != servoCommand) {
+        // Another length byte may be the real start of a frame
+        position = data == frameLength ? 1 : 0;
+        sum = frameLength;
+        return;
+      }
+      sum += data;
+      position = 2;
+      return;
+  }
+
+  if (position < checksumStart) { // Channel bytes go straight into the back buffer
+    volatile uint16_t &channel = channels[frontBuffer ^ 1][(position - 2) >> 1];
+
+    if (position & 1) {
+      channel |= (uint16_t)data << 8;
+    } else {
+      channel = data;
+    }
+
+    sum += data;
+    position++;
+  } else if (position == checksumStart) { // Checksum low byte
+    checksum = data;
+    position++;
+  } else { // Checksum high byte, the frame is complete
+    checksum |= (uint16_t)data << 8;
+    position = 0;
+
+    if (checksum == (uint16_t)(0xFFFF - sum)) {
+      frontBuffer ^= 1;
+      sequence++;
+    } else {
+      badFrames++;
+    }
+  }
+}
+
+
+bool IBusDecoder::readFrame(uint8_t &lastSequence, uint16_t frame[maxChannels]) {
+  uint8_t current = sequence;
+
+  if (current == lastSequence) {
+    return false;
+  }
+
+  // A frame published during the copy changes the sequence, so the copy is taken again
+  uint8_t before;
+  do {
+    before = current;
+    const volatile uint16_t *front = channels[frontBuffer];
+
+    for (uint8_t i = 0; i < maxChannels; i++) {
+      frame[i] = front[i];
+    }
+
+    current = sequence;
+  } while (current != before);
+
+  lastSequence = current;
+
+  return true;
+}
+
+
+uint8_t IBusDecoder::getSequence() {
+  return sequence;
+}
+
+
+uint16_t IBusDecoder::getBadFrames() {
+  return badFrames;
+}
+
+
+bool IBusDecoder::isIdle() {
+  return position == 0;
+}
@@ -0,0 +1,94 @@
+#ifndef IBUS_DECODER
+#define IBUS_DECODER
+
+#include <stdint.h>
+
+/*-----------------------------------------------------------------------------*/
+/** @file   IBusDecoder.hpp
+ * @brief   Header for IBusDecoder class (byte-fed FlySky iBus frame decoder)
+*//*---------------------------------------------------------------------------*/
+
+
+/**
+ * @brief Class used to decode iBus servo frames one byte at a time
+ * 
+ * @note Frames are 32 bytes: length (0x20), command (0x40), 14 little-endian channels,
+ * and a little-endian checksum of 0xFFFF minus the sum of the first 30 bytes.
+ * Channels are written into a back buffer as they arrive, and a frame is only published 
+ * (by swapping buffers and bumping the sequence counter) once its checksum matches.
+ * handleByte() is safe to call from the UART RX interrupt and has no hardware dependencies, 
+ * so the decoder can be fed recorded byte streams on the host.
+ */
+class IBusDecoder {
+  public:
+    static const uint8_t maxChannels = 14; // Number of channels in an iBus servo frame
+
+  private:
+    static const uint8_t frameLength = 0x20;  // Length byte at the start of every servo frame
+    static const uint8_t servoCommand = 0x40; // Command byte of a servo frame
+    static const uint8_t checksumStart = 30;  // Position of the checksum in the frame
+
+    volatile uint16_t channels[2][maxChannels]; // Double-buffered channel values
+    volatile uint8_t frontBuffer = 0;   // Index of the buffer holding the latest complete frame
+    volatile uint8_t sequence = 0;      // Incremented every time a frame is published
+
+    uint8_t position = 0;    // Position of the next byte in the current frame
+    uint16_t sum = 0;        // Running sum of the current frame
+    uint16_t checksum = 0;   // Checksum received with the current frame
+
+    volatile uint16_t badFrames = 0; // Number of frames dropped due to a checksum mismatch
+
+  public:
+    /**
+     * @brief Defines a new IBusDecoder with all channels at zero
+     */
+    IBusDecoder();
+
+
+    /**
+     * @brief Feeds one received byte to the decoder
+     * 
+     * @param data Byte received from the UART
+     */
+    void handleByte(uint8_t data);
+
+
+    /**
+     * @brief Copies the latest complete frame if it is newer than the one last read
+     * 
+     * @note Once the next frame is published, the old front buffer becomes the back buffer and is 
+     * overwritten byte by byte. The copy is retried until the sequence number is the same before and 
+     * after it, so it never mixes two frames and doesn't need interrupts disabled
+     * 
+     * @param lastSequence Sequence number of the last frame read, updated when a new frame is returned
+     * @param frame Array of maxChannels filled with the channel values of the latest frame
+     * @return Condition for if a new frame was available
+     */
+    bool readFrame(uint8_t &lastSequence, uint16_t frame[maxChannels]);
+
+
+    /**
+     * @brief Gets the sequence number of the latest complete frame
+     * 
+     * @return Number of frames published (Wraps at 256)
+     */
+    uint8_t getSequence();
+
+
+    /**
+     * @brief Gets the number of frames dropped because of a bad checksum
+     * 
+     * @return Number of dropped frames
+     */
+    uint16_t getBadFrames();
+
+
+    /**
+     * @brief Gets the condition for if the decoder is between frames
+     * 
+     * @return Condition for if the decoder is waiting for the length byte of a new frame
+     */
+    bool isIdle();
+};
+
+#endif // IBUS_DECODER
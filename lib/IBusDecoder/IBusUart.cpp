@@ -0,0 +1,96 @@
+#include "IBusUart.hpp"
+
+#if defined(IBUS_UART_ISR) && !defined(TELEMETRY_UART_ISR)
+#error "IBUS_UART_ISR needs TELEMETRY_UART_ISR, writing to Serial links HardwareSerial0, which defines USART_RX_vect as well"
+#endif
+
+IBusDecoder IBusUart::decoder;
+IBusUart::SideHandler IBusUart::sideHandler = nullptr;
+uint8_t IBusUart::sideSync = 0;
+volatile bool IBusUart::sideActive = false;
+uint32_t IBusUart::lastByteTime = 0;
+uint32_t IBusUart::quietTime = 0;
+const uint32_t IBusUart::sideGap;
+
+
+void IBusUart::setSideChannel(uint8_t sync, SideHandler handler) {
+  noInterrupts();
+  sideSync = sync;
+  sideHandler = handler;
+  sideActive = false;
+  interrupts();
+}
+
+
+void IBusUart::handleByte(uint8_t data, bool afterGap) {
+  // Side channel frames only start in the quiet gap between iBus frames, and keep every byte until they end
+  if (sideActive || (sideHandler != nullptr && data == sideSync && afterGap && decoder.isIdle())) {
+    sideActive = sideHandler(data);
+  } else {
+    decoder.handleByte(data);
+  }
+}
+
+
+#if defined(IBUS_UART_ISR) && defined(__AVR__)
+
+void IBusUart::begin(unsigned long baudrate) {
+  // Double speed mode keeps the baudrate error low at 115200
+  UCSR0A = _BV(U2X0);
+  UBRR0 = (F_CPU / 4 / baudrate - 1) / 2;
+
+  // 8 data bits, no parity, 1 stop bit with the receiver, RX interrupt, and transmitter enabled
+  UCSR0C = _BV(UCSZ01) | _BV(UCSZ00);
+  UCSR0B = _BV(RXEN0) | _BV(RXCIE0) | _BV(TXEN0);
+}
+
+
+void IBusUart::poll() {}
+
+
+void IBusUart::receiveByte(uint8_t data, uint8_t status) {
+  // Byte times are exact here, so the gap is measured from the previous byte
+  uint32_t now = micros();
+  bool afterGap = now - lastByteTime >= sideGap;
+  lastByteTime = now;
+
+  // Drops bytes with framing errors instead of letting them corrupt the frame
+  if (!(status & _BV(FE0))) {
+    handleByte(data, afterGap);
+  }
+}
+
+
+ISR(USART_RX_vect) {
+  // The status has to be read before the data register
+  uint8_t status = UCSR0A;
+  IBusUart::receiveByte(UDR0, status);
+}
+
+#else
+
+void IBusUart::begin(unsigned long baudrate) {
+  Serial.begin(baudrate);
+}
+
+
+void IBusUart::poll() {
+  uint32_t now = micros();
+
+  // Polls that find nothing show the line was quiet from the last byte until then
+  if (Serial.available() <= 0) {
+    quietTime = now;
+    return;
+  }
+
+  // Bytes buffered between polls lose their timing, so only the first one can follow a known gap
+  bool afterGap = quietTime - lastByteTime >= sideGap;
+  while (Serial.available() > 0) {
+    handleByte(Serial.read(), afterGap);
+    afterGap = false;
+  }
+
+  lastByteTime = quietTime = now;
+}
+
+#endif
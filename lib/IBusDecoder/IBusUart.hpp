@@ -0,0 +1,99 @@
+#ifndef IBUS_UART
+#define IBUS_UART
+
+#include <Arduino.h>
+#include "IBusDecoder.hpp"
+
+/*-----------------------------------------------------------------------------*/
+/** @file   IBusUart.hpp
+ * @brief   Header for IBusUart class (connects the iBus decoder to the UART)
+*//*---------------------------------------------------------------------------*/
+
+
+/**
+ * @brief Class used to feed received UART bytes to the shared IBusDecoder
+ * 
+ * @note With the IBUS_UART_ISR build flag on an AVR board, the decoder is fed straight from 
+ * the USART RX interrupt. Any use of Serial links HardwareSerial0, which defines both USART 
+ * interrupts, so the flag needs TELEMETRY_UART_ISR for the transmit side and nothing in the 
+ * sketch may touch Serial (The library text printers compile to nothing). Build the uno_isr 
+ * environment to check it. Without the flag, poll() moves the bytes HardwareSerial has 
+ * buffered into the decoder.
+ * 
+ * @note A side channel can share the RX line in the gaps between iBus frames. A byte equal to 
+ * its sync byte that arrives while the decoder is idle, after the line has been quiet for at least 
+ * sideGap, goes to the side channel handler instead, along with every following byte until the 
+ * handler returns false. Channel bytes of a frame arrive back to back, so a sync value inside a 
+ * frame (Even one the decoder is still hunting for) never starts a side channel frame.
+ * 
+ * @note On the Uno the 16U2's TX drives RX (D0) through a 1 kOhm resistor, which a receiver 
+ * wired straight to D0 overpowers. See the TuningLink section of the README for the diode wiring.
+ */
+class IBusUart {
+  public:
+    static const uint32_t sideGap = 500; // Quiet time before a side channel sync byte in microseconds (About 6 bytes at 115200)
+
+    /**
+     * @brief Side channel byte handler, returns the condition for if it wants the next byte too
+     */
+    typedef bool (*SideHandler)(uint8_t data);
+
+  private:
+    static SideHandler sideHandler;  // Handler of the side channel (nullptr for none)
+    static uint8_t sideSync;         // First byte of every side channel frame
+    static volatile bool sideActive; // Condition for if a side channel frame is in progress
+    static uint32_t lastByteTime;    // micros() when the last byte was received (Latest poll that found bytes without IBUS_UART_ISR)
+    static uint32_t quietTime;       // micros() of the latest poll that found no bytes (Unused with IBUS_UART_ISR)
+
+  public:
+    static IBusDecoder decoder; // Decoder fed by the UART
+
+
+    /**
+     * @brief Starts the UART for iBus reception
+     * 
+     * @param baudrate Baudrate of the iBus receiver
+     */
+    static void begin(unsigned long baudrate);
+
+
+    /**
+     * @brief Feeds any buffered bytes to the decoder
+     * 
+     * @note Does nothing when the RX interrupt feeds the decoder directly
+     */
+    static void poll();
+
+
+    /**
+     * @brief Sends the bytes of frames starting with a sync byte to a handler instead of the decoder
+     * 
+     * @note The handler runs in the RX interrupt with IBUS_UART_ISR, so it should only store the byte
+     * 
+     * @param sync First byte of every side channel frame (Not 0x20)
+     * @param handler Handler of the side channel bytes (nullptr to remove the side channel)
+     */
+    static void setSideChannel(uint8_t sync, SideHandler handler);
+
+
+    /**
+     * @brief Routes a received byte to the side channel or the decoder
+     * 
+     * @param data Byte received from the UART
+     * @param afterGap Condition for if the line was quiet for at least sideGap before the byte
+     */
+    static void handleByte(uint8_t data, bool afterGap);
+
+
+    /**
+     * @brief Times a byte from the RX interrupt and routes it, dropping it on a framing error
+     * 
+     * @note Only defined in the IBUS_UART_ISR build on AVR, where the USART RX interrupt calls it
+     * 
+     * @param data Byte read from the data register
+     * @param status Status register, read before the data register
+     */
+    static void receiveByte(uint8_t data, uint8_t status);
+};
+
+#endif // IBUS_UART
@@ -0,0 +1,91 @@
+#include "LoopProfiler.hpp"
+
+#ifdef LOOP_PROFILER
+
+#include <Telemetry.hpp>
+
+LoopProfiler::Stage LoopProfiler::stages[maxStages];
+uint8_t LoopProfiler::dumpPosition = 0;
+
+
+void LoopProfiler::setStage(uint8_t id, const char *name, uint32_t budgetMicros) {
+  if (id >= maxStages) {
+    return;
+  }
+
+  stages[id].name = name;
+  stages[id].budget = budgetMicros;
+  reset();
+}
+
+
+void LoopProfiler::record(uint8_t id, uint32_t elapsed) {
+  if (id >= maxStages) {
+    return;
+  }
+
+  Stage &stage = stages[id];
+
+  if (stage.count == 0 || elapsed < stage.minTime) { stage.minTime = elapsed; }
+  if (elapsed > stage.maxTime) { stage.maxTime = elapsed; }
+  if (stage.budget && elapsed > stage.budget) { stage.overruns++; }
+  stage.count++;
+
+  // Bucket is the bit length of the duration
+  uint8_t bucket = 0;
+  for (uint32_t remaining = elapsed; remaining && bucket < numBuckets - 1; remaining >>= 1) {
+    bucket++;
+  }
+
+  if (stage.buckets[bucket] != 0x7FFF) {
+    stage.buckets[bucket]++;
+  }
+}
+
+
+void LoopProfiler::reset() {
+  for (uint8_t i = 0; i < maxStages; i++) {
+    stages[i].count = 0;
+    stages[i].minTime = 0;
+    stages[i].maxTime = 0;
+    stages[i].overruns = 0;
+
+    for (uint8_t b = 0; b < numBuckets; b++) {
+      stages[i].buckets[b] = 0;
+    }
+  }
+}
+
+
+bool LoopProfiler::dumpNext() {
+  // Skips stages without names
+  while (dumpPosition < 2 * maxStages && stages[dumpPosition >> 1].name == nullptr) {
+    dumpPosition += 2;
+  }
+
+  if (dumpPosition >= 2 * maxStages) {
+    dumpPosition = 0;
+    return false;
+  }
+
+  uint8_t id = dumpPosition >> 1;
+  Stage &stage = stages[id];
+  bool sent;
+
+  if (!(dumpPosition & 1)) {
+    int32_t timings[5] = {
+      (int32_t)stage.count, (int32_t)stage.minTime, (int32_t)stage.maxTime, (int32_t)stage.overruns, (int32_t)stage.budget
+    };
+    sent = Telemetry::send(Telemetry::PROFILE, id, timings, 5);
+  } else {
+    sent = Telemetry::send(Telemetry::PROFILE_HISTOGRAM, id, (const int16_t *)stage.buckets, numBuckets);
+  }
+
+  if (sent) {
+    dumpPosition++;
+  }
+
+  return true;
+}
+
+#endif // LOOP_PROFILER
@@ -0,0 +1,130 @@
+#ifndef LOOP_PROFILER_H
+#define LOOP_PROFILER_H
+
+#include <Arduino.h>
+
+/*-----------------------------------------------------------------------------*/
+/** @file   LoopProfiler.hpp
+ * @brief   Header for LoopProfiler class (per-stage timing histograms)
+*//*---------------------------------------------------------------------------*/
+
+
+/**
+ * Build with -D LOOP_PROFILER to enable profiling. Without it, every PROFILE_ macro 
+ * expands to nothing (PROFILE_DUMP_NEXT() to false), so instrumented code costs no time or RAM.
+ * 
+ * Usage:
+ *   PROFILE_SET_STAGE(0, "rc update", 500);  // Names stage 0 with a 500 us budget
+ *   { PROFILE_SCOPE(0); rc.update(); }       // Times everything until the end of the scope
+ *   while (PROFILE_DUMP_NEXT()) {}           // Sends every named stage as telemetry, one record per call
+ */
+
+#ifdef LOOP_PROFILER
+
+#ifndef LOOP_PROFILER_MAX_STAGES
+#define LOOP_PROFILER_MAX_STAGES 8 // Number of stages that can be profiled (Override with a build flag)
+#endif
+
+
+/**
+ * @brief Class used to record how long named stages of the loop take
+ * 
+ * @note Times come from micros(), which has a resolution of 4 us on a 16 MHz Uno.
+ * Each histogram bucket counts durations of the same bit length, so bucket b holds 
+ * durations from 2^(b - 1) up to 2^b - 1 us, and the last bucket holds everything longer.
+ */
+class LoopProfiler {
+  public:
+    static const uint8_t maxStages = LOOP_PROFILER_MAX_STAGES; // Number of stages that can be profiled
+    static const uint8_t numBuckets = 16;                      // Number of histogram buckets per stage
+
+    /**
+     * @brief Times a stage from construction until the end of the scope
+     */
+    class Scope {
+      private:
+        uint8_t stage;  // Stage being timed
+        uint32_t start; // Time the stage started in microseconds
+
+      public:
+        inline Scope(uint8_t id) : stage(id), start(micros()) {}
+        inline ~Scope() { LoopProfiler::record(stage, micros() - start); }
+    };
+
+  private:
+    /**
+     * @brief Timing data of a single stage
+     */
+    struct Stage {
+      const char *name;             // Name of the stage, stages without names aren't printed
+      uint32_t budget;              // Longest acceptable duration in microseconds (0 for no budget)
+      uint32_t count;               // Number of recorded durations
+      uint32_t minTime;             // Shortest recorded duration in microseconds
+      uint32_t maxTime;             // Longest recorded duration in microseconds
+      uint32_t overruns;            // Number of durations longer than the budget
+      uint16_t buckets[numBuckets]; // Histogram of durations (Saturates at 32767, so it can be sent as int16)
+    };
+
+    static Stage stages[maxStages]; // Timing data of every stage
+    static uint8_t dumpPosition;    // Next record dumpNext() sends, two per stage (Timings, then histogram)
+
+  public:
+    /**
+     * @brief Names a stage and sets its budget
+     * 
+     * @param id ID of the stage
+     * @param name Name printed with the stage's data
+     * @param budgetMicros Longest acceptable duration in microseconds (0 for no budget)
+     */
+    static void setStage(uint8_t id, const char *name, uint32_t budgetMicros = 0);
+
+
+    /**
+     * @brief Records a duration for a stage
+     * 
+     * @param id ID of the stage
+     * @param elapsed Duration in microseconds
+     */
+    static void record(uint8_t id, uint32_t elapsed);
+
+
+    /**
+     * @brief Clears the timing data of every stage (Names and budgets are kept)
+     */
+    static void reset();
+
+
+    /**
+     * @brief Sends the next record of the named stages over Telemetry
+     * 
+     * @note Each stage is a PROFILE record of its timings followed by a PROFILE_HISTOGRAM record, 
+     * with the stage ID as the record ID. A record that doesn't fit in the telemetry buffer is sent 
+     * again on the next call, so the dump never mixes with other output on the port
+     * 
+     * @return Condition for if there are records left to send (False once every stage has been sent, 
+     * the next call starts over)
+     */
+    static bool dumpNext();
+};
+
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+
+#define PROFILE_SET_STAGE(id, name, budget) LoopProfiler::setStage((id), (name), (budget))
+#define PROFILE_SCOPE(id) LoopProfiler::Scope PROFILE_CONCAT(profileScope, __LINE__)(id)
+#define PROFILE_RECORD(id, elapsed) LoopProfiler::record((id), (elapsed))
+#define PROFILE_RESET() LoopProfiler::reset()
+#define PROFILE_DUMP_NEXT() LoopProfiler::dumpNext()
+
+#else
+
+#define PROFILE_SET_STAGE(id, name, budget)
+#define PROFILE_SCOPE(id)
+#define PROFILE_RECORD(id, elapsed)
+#define PROFILE_RESET()
+#define PROFILE_DUMP_NEXT() false
+
+#endif // LOOP_PROFILER
+
+#endif // LOOP_PROFILER_H
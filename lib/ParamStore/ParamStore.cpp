@@ -0,0 +1,251 @@
+#include "ParamStore.hpp"
+
+namespace {
+  /**
+   * @brief Adds a byte to a CRC-16/CCITT (Polynomial 0x1021)
+   */
+  inline uint16_t crcUpdate(uint16_t crc, uint8_t data) {
+    crc ^= (uint16_t)data << 8;
+    for (uint8_t i = 0; i < 8; i++) {
+      crc = crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+    return crc;
+  }
+
+
+  /**
+   * @brief Gets the condition for if the EEPROM can take another byte without waiting
+   */
+  inline bool eepromReady() {
+#ifdef __AVR__
+    return eeprom_is_ready();
+#else
+    return true;
+#endif
+  }
+}
+
+
+const uint8_t ParamStore::headerSize;
+const uint8_t ParamStore::defaultSlots;
+
+
+/* ---------------------- ParamStore Constructors ---------------------- */
+
+ParamStore::ParamStore(void *data, const void *defaultData, uint16_t size, uint16_t layoutVersion, uint16_t address, uint8_t slotCount) {
+  block = (uint8_t *)data;
+  defaults = (const uint8_t *)defaultData;
+  blockSize = size;
+  version = layoutVersion;
+  baseAddress = address;
+
+  // At most 8 slots (Tracked in a byte while loading), and only as many as fit in the EEPROM
+  slots = constrain(slotCount, 1, 8);
+  while (slots > 1 && (uint32_t)address + getFootprint() > EEPROM.length()) {
+    slots--;
+  }
+}
+
+/* --------------------------------------------------------------------- */
+
+
+
+/* ------------------------- ParamStore Methods ------------------------ */
+
+ParamStore::Source ParamStore::load() {
+  uint8_t rejected = 0; // Slots whose CRC failed
+
+  // Tries the newest copy first, then the next newest if it is damaged
+  while (true) {
+    int8_t newest = -1;
+    SlotHeader newestHeader;
+
+    for (uint8_t slot = 0; slot < slots; slot++) {
+      SlotHeader header;
+      if (rejected & (1 << slot) || !readHeader(slot, header)) {
+        continue;
+      }
+
+      if (newest < 0 || (int16_t)(header.sequence - newestHeader.sequence) > 0) {
+        newest = slot;
+        newestHeader = header;
+      }
+    }
+
+    if (newest < 0) {
+      break;
+    }
+
+    if (readBlock(newest, newestHeader, block)) {
+      currentSlot = newest;
+      sequence = newestHeader.sequence;
+      storedCrc = newestHeader.crc;
+      return EEPROM_SLOT;
+    }
+
+    rejected |= 1 << newest;
+  }
+
+  // Nothing valid, the next save starts from the first slot
+  loadDefaults();
+  currentSlot = -1;
+  sequence = 0;
+  return DEFAULTS;
+}
+
+
+bool ParamStore::save() {
+  beginSave();
+
+  SaveState state;
+  while ((state = pollSave()) == SAVE_BUSY) {}
+
+  return state == SAVE_DONE;
+}
+
+
+void ParamStore::beginSave() {
+  if (saveState == SAVE_BUSY) {
+    return;
+  }
+
+  if (!isModified()) {
+    saveState = SAVE_DONE;
+    return;
+  }
+
+  saveSlot = currentSlot < 0 ? 0 : (currentSlot + 1) % slots;
+  savePosition = 0;
+
+  saveHeader.version = version;
+  saveHeader.size = blockSize;
+  saveHeader.sequence = sequence + 1;
+  saveHeader.crc = headerCrc(saveHeader);
+  saveState = SAVE_BUSY;
+}
+
+
+ParamStore::SaveState ParamStore::pollSave() {
+  if (saveState != SAVE_BUSY || !eepromReady()) {
+    return saveState;
+  }
+
+  uint16_t address = slotAddress(saveSlot);
+  uint16_t end = blockSize + headerSize;
+
+  // Block first and header last, so an interrupted save leaves an invalid slot
+  while (savePosition < end) {
+    uint8_t data;
+    uint16_t target;
+
+    if (savePosition < blockSize) {
+      data = block[savePosition];
+      target = address + headerSize + savePosition;
+      saveHeader.crc = crcUpdate(saveHeader.crc, data);
+    } else {
+      data = ((const uint8_t *)&saveHeader)[savePosition - blockSize];
+      target = address + savePosition - blockSize;
+    }
+    savePosition++;
+
+    // Skips bytes that already match, and writes at most one byte per call
+    if (EEPROM.read(target) != data) {
+      EEPROM.write(target, data);
+      return SAVE_BUSY;
+    }
+  }
+
+  // Reads the copy back before trusting it
+  SlotHeader written;
+  if (!readHeader(saveSlot, written) || written.crc != saveHeader.crc || !readBlock(saveSlot, written, nullptr)) {
+    return saveState = SAVE_FAILED;
+  }
+
+  currentSlot = saveSlot;
+  sequence = saveHeader.sequence;
+  storedCrc = saveHeader.crc;
+  return saveState = SAVE_DONE;
+}
+
+
+bool ParamStore::isSaving() {
+  return saveState == SAVE_BUSY;
+}
+
+
+void ParamStore::loadDefaults() {
+  memcpy_P(block, defaults, blockSize);
+}
+
+
+bool ParamStore::isModified() {
+  if (currentSlot < 0) {
+    return true;
+  }
+
+  // The RAM block with the current header gives the stored CRC if nothing changed
+  SlotHeader header = {version, blockSize, sequence, 0};
+  return crc16(headerCrc(header), block, blockSize) != storedCrc;
+}
+
+
+uint16_t ParamStore::getSequence() {
+  return sequence;
+}
+
+
+uint16_t ParamStore::getFootprint() {
+  return slots * (headerSize + blockSize);
+}
+
+
+void *ParamStore::getBlock() {
+  return block;
+}
+
+
+uint16_t ParamStore::getSize() {
+  return blockSize;
+}
+
+
+uint16_t ParamStore::crc16(uint16_t crc, const uint8_t *data, uint16_t size) {
+  for (uint16_t i = 0; i < size; i++) {
+    crc = crcUpdate(crc, data[i]);
+  }
+  return crc;
+}
+
+
+uint16_t ParamStore::slotAddress(uint8_t slot) {
+  return baseAddress + slot * (headerSize + blockSize);
+}
+
+
+bool ParamStore::readHeader(uint8_t slot, SlotHeader &header) {
+  EEPROM.get(slotAddress(slot), header);
+  return header.version == version && header.size == blockSize;
+}
+
+
+uint16_t ParamStore::headerCrc(const SlotHeader &header) {
+  return crc16(0xFFFF, (const uint8_t *)&header, sizeof(SlotHeader) - sizeof(header.crc));
+}
+
+
+bool ParamStore::readBlock(uint8_t slot, const SlotHeader &header, uint8_t *buffer) {
+  uint16_t address = slotAddress(slot) + headerSize;
+  uint16_t crc = headerCrc(header);
+
+  for (uint16_t i = 0; i < blockSize; i++) {
+    uint8_t data = EEPROM.read(address + i);
+    crc = crcUpdate(crc, data);
+    if (buffer != nullptr) {
+      buffer[i] = data;
+    }
+  }
+
+  return crc == header.crc;
+}
+
+/* --------------------------------------------------------------------- */
@@ -0,0 +1,227 @@
+#ifndef PARAM_STORE
+#define PARAM_STORE
+
+#include <Arduino.h>
+#include <EEPROM.h>
+
+/*-----------------------------------------------------------------------------*/
+/** @file   ParamStore.hpp
+ * @brief   Header for ParamStore class (versioned, CRC checked settings block in EEPROM)
+*//*---------------------------------------------------------------------------*/
+
+
+/**
+ * @brief Class used to keep a block of settings in EEPROM so they can change without a reflash
+ * 
+ * @note The block is any plain struct in RAM. EEPROM is split into slots, each a header 
+ * (version, size, sequence number, CRC-16) followed by a copy of the block. Every save goes to 
+ * the slot after the newest one, so wear is spread over all of them, and only bytes that differ 
+ * from what the slot already holds are written. The header is written last, so a save cut off 
+ * by a reset fails its CRC and the previous slot is loaded instead. If no slot has a valid copy 
+ * with the same version and size, the defaults are loaded. Bump the version whenever the 
+ * struct changes.
+ * 
+ * @note Each EEPROM byte write takes about 3.3 ms on AVR, so save() doesn't belong in a control loop.
+ * beginSave() and pollSave() do the same save one byte per call, without waiting for the EEPROM.
+ */
+class ParamStore {
+  public:
+    /**
+     * @brief State of a save started with beginSave()
+     */
+    enum SaveState {
+      SAVE_DONE = 0, // Saved and read back, or nothing needed saving
+      SAVE_BUSY,     // Still writing
+      SAVE_FAILED    // The saved copy didn't read back with a valid CRC
+    };
+
+  private:
+    /**
+     * @brief Header written in front of every copy of the block
+     */
+    struct SlotHeader {
+      uint16_t version;  // Layout version of the block
+      uint16_t size;     // Size of the block in bytes
+      uint16_t sequence; // Save count, the highest valid one is the newest (Wraps)
+      uint16_t crc;      // CRC-16/CCITT of the version, size, sequence, and block
+    };
+
+    uint8_t *block;           // Settings block in RAM
+    const uint8_t *defaults;  // Default settings block in program memory (PROGMEM)
+    uint16_t blockSize;       // Size of the block in bytes
+    uint16_t version;         // Layout version of the block
+    uint16_t baseAddress;     // EEPROM address of the first slot
+    uint8_t slots;            // Number of slots
+
+    int8_t currentSlot = -1;  // Slot the block was last loaded from or saved to (-1 for none)
+    uint16_t sequence = 0;    // Sequence number of the current slot
+    uint16_t storedCrc = 0;   // CRC of the current slot
+
+    SaveState saveState = SAVE_DONE; // State of the last save started with beginSave()
+    uint8_t saveSlot;                // Slot being written
+    uint16_t savePosition;           // Next byte of the save (Block bytes, then header bytes)
+    SlotHeader saveHeader;           // Header of the slot being written, its CRC is built as the block is written
+
+    /**
+     * @brief Gets the EEPROM address of a slot
+     */
+    uint16_t slotAddress(uint8_t slot);
+
+
+    /**
+     * @brief Reads a slot's header and checks that it is for this block
+     * 
+     * @param slot Slot to read
+     * @param header Header read from the slot
+     * @return Condition for if the version and size match
+     */
+    bool readHeader(uint8_t slot, SlotHeader &header);
+
+
+    /**
+     * @brief Computes the CRC of a header without its CRC field
+     */
+    static uint16_t headerCrc(const SlotHeader &header);
+
+
+    /**
+     * @brief Copies a slot into a buffer while checking its CRC
+     * 
+     * @param slot Slot to read
+     * @param header Header of the slot
+     * @param buffer Buffer to copy the block into (nullptr to only check the CRC)
+     * @return Condition for if the CRC matches
+     */
+    bool readBlock(uint8_t slot, const SlotHeader &header, uint8_t *buffer);
+
+  public:
+    static const uint8_t headerSize = sizeof(SlotHeader); // Bytes in front of each copy of the block
+    static const uint8_t defaultSlots = 4;                // Number of slots used if none are given
+
+    /**
+     * @brief Where the block in RAM came from
+     */
+    enum Source {
+      DEFAULTS = 0, // No valid copy in EEPROM
+      EEPROM_SLOT   // Newest valid copy in EEPROM
+    };
+
+
+    /**
+     * @brief Defines a parameter store for a settings block
+     * 
+     * @param data Settings block in RAM
+     * @param defaultData Default settings block, stored with PROGMEM
+     * @param size Size of the block in bytes
+     * @param layoutVersion Version of the block's layout (Change it when the struct changes)
+     * @param address EEPROM address of the first slot
+     * @param slotCount Number of slots to spread the writes over
+     */
+    ParamStore(void *data, const void *defaultData, uint16_t size, uint16_t layoutVersion, uint16_t address = 0, uint8_t slotCount = defaultSlots);
+
+
+    /**
+     * @brief Loads the newest valid copy of the block, or the defaults if there isn't one
+     * 
+     * @note Only the headers are read to find the newest copy, then it is checked and copied in one pass
+     * 
+     * @return Where the block was loaded from
+     */
+    Source load();
+
+
+    /**
+     * @brief Saves the block in RAM to the next slot
+     * 
+     * @note Nothing is written if the newest copy already matches the block
+     * 
+     * @return Condition for if the saved copy reads back with a valid CRC
+     */
+    bool save();
+
+
+    /**
+     * @brief Starts saving the block without waiting for the EEPROM
+     * 
+     * @note Nothing is started if a save is running or the newest copy already matches the block.
+     * The block must not change until pollSave() stops returning SAVE_BUSY.
+     */
+    void beginSave();
+
+
+    /**
+     * @brief Writes the next changed byte of a save started with beginSave()
+     * 
+     * @note Returns right away while the EEPROM is still busy with the previous byte
+     * 
+     * @return State of the save
+     */
+    SaveState pollSave();
+
+
+    /**
+     * @brief Gets the condition for if a save is running
+     * 
+     * @return Condition for if pollSave() still has bytes to write
+     */
+    bool isSaving();
+
+
+    /**
+     * @brief Copies the defaults into the block in RAM (Call save() to keep them)
+     */
+    void loadDefaults();
+
+
+    /**
+     * @brief Gets the condition for if the block in RAM differs from the newest copy
+     * 
+     * @return Condition for if save() would write
+     */
+    bool isModified();
+
+
+    /**
+     * @brief Gets the sequence number of the newest copy
+     * 
+     * @return Number of saves (Wraps)
+     */
+    uint16_t getSequence();
+
+
+    /**
+     * @brief Gets the number of EEPROM bytes the store uses
+     * 
+     * @return Size of every slot together
+     */
+    uint16_t getFootprint();
+
+
+    /**
+     * @brief Gets the settings block in RAM
+     * 
+     * @return Pointer to the block
+     */
+    void *getBlock();
+
+
+    /**
+     * @brief Gets the size of the settings block
+     * 
+     * @return Size of the block in bytes
+     */
+    uint16_t getSize();
+
+
+    /**
+     * @brief Computes a CRC-16/CCITT (Polynomial 0x1021)
+     * 
+     * @param crc Starting value (0xFFFF for a new CRC)
+     * @param data Bytes to add
+     * @param size Number of bytes
+     * @return Updated CRC
+     */
+    static uint16_t crc16(uint16_t crc, const uint8_t *data, uint16_t size);
+};
+
+#endif // PARAM_STORE
@@ -0,0 +1,62 @@
+#include "GainSchedule.hpp"
+
+/* ------------------- GainSchedule Constructors ------------------- */
+
+GainSchedule::GainSchedule(const GainPoint *progmemTable, uint8_t tableSize) {
+  table = progmemTable;
+  size = tableSize;
+}
+
+/* ----------------------------------------------------------------- */
+
+
+
+/* --------------------- GainSchedule Methods ---------------------- */
+
+Fixed16 GainSchedule::keyAt(uint8_t index) const {
+  return Fixed16::fromRaw((int32_t)pgm_read_dword(&table[index].key));
+}
+
+
+void GainSchedule::lookup(Fixed16 key, GainSet &gains) {
+  GainPoint low;
+  GainPoint high;
+
+  // Walks from the previous row, the scheduling variable rarely jumps far between lookups
+  while (segment > 0 && key < keyAt(segment)) {
+    segment--;
+  }
+  while (segment + 1 < size && key >= keyAt(segment + 1)) {
+    segment++;
+  }
+
+  memcpy_P(&low, &table[segment], sizeof(GainPoint));
+
+  // Clamps to the first or last row outside the table
+  if (segment + 1 >= size || key <= Fixed16::fromRaw(low.key)) {
+    gains.kP = Fixed16::fromRaw(low.kP);
+    gains.kI = Fixed16::fromRaw(low.kI);
+    gains.kD = Fixed16::fromRaw(low.kD);
+    gains.feedforward = Fixed16::fromRaw(low.feedforward);
+    return;
+  }
+
+  memcpy_P(&high, &table[segment + 1], sizeof(GainPoint));
+
+  // Fraction of the way from the low row to the high row
+  Fixed16 lowKey = Fixed16::fromRaw(low.key);
+  Fixed16 fraction = (key - lowKey) / (Fixed16::fromRaw(high.key) - lowKey);
+
+  gains.kP = Fixed16::fromRaw(low.kP) + (Fixed16::fromRaw(high.kP) - Fixed16::fromRaw(low.kP)) * fraction;
+  gains.kI = Fixed16::fromRaw(low.kI) + (Fixed16::fromRaw(high.kI) - Fixed16::fromRaw(low.kI)) * fraction;
+  gains.kD = Fixed16::fromRaw(low.kD) + (Fixed16::fromRaw(high.kD) - Fixed16::fromRaw(low.kD)) * fraction;
+  gains.feedforward = Fixed16::fromRaw(low.feedforward) 
+    + (Fixed16::fromRaw(high.feedforward) - Fixed16::fromRaw(low.feedforward)) * fraction;
+}
+
+
+uint8_t GainSchedule::getSize() const {
+  return size;
+}
+
+/* ----------------------------------------------------------------- */
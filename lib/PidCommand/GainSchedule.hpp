@@ -0,0 +1,99 @@
+#ifndef GAIN_SCHEDULE
+#define GAIN_SCHEDULE
+
+#include <Arduino.h>
+#include <FixedPoint.hpp>
+
+/*-----------------------------------------------------------------------------*/
+/** @file    GainSchedule.hpp
+  * @brief   Header for GainSchedule class (interpolated PID gains from a PROGMEM table)
+*//*---------------------------------------------------------------------------*/
+
+
+/**
+ * @brief Converts a constant to a raw Q16.16 value at compile time (Used to fill GainPoint tables)
+ */
+#define FIXED16_RAW(value) ((int32_t)((value) * 65536.0 + ((value) < 0 ? -0.5 : 0.5)))
+
+
+/**
+ * @brief Builds a GainPoint from floating-point constants
+ * 
+ * @note Example: GAIN_POINT(1.5, 2.0, 0.5, 0.01, 20.0)
+ */
+#define GAIN_POINT(key, kP, kI, kD, feedforward) \
+  { FIXED16_RAW(key), FIXED16_RAW(kP), FIXED16_RAW(kI), FIXED16_RAW(kD), FIXED16_RAW(feedforward) }
+
+
+/**
+ * @brief One row of a gain schedule, every value is a raw Q16.16 number
+ */
+struct GainPoint {
+  int32_t key;         // Value of the scheduling variable for this row (Rows must be in increasing order)
+  int32_t kP;          // Proportional gain
+  int32_t kI;          // Integral gain
+  int32_t kD;          // Derivative gain
+  int32_t feedforward; // Output added before the output range is applied (0 for none)
+};
+
+
+/**
+ * @brief Gains looked up from a gain schedule
+ */
+struct GainSet {
+  Fixed16 kP;
+  Fixed16 kI;
+  Fixed16 kD;
+  Fixed16 feedforward;
+};
+
+
+/**
+ * @brief Class used to look up PID gains from a table in program memory
+ * 
+ * @note Values between two rows are linearly interpolated, values outside the table use the first or last row
+ */
+class GainSchedule {
+  private:
+    const GainPoint *table; // Table of rows in PROGMEM
+    uint8_t size;           // Number of rows in the table
+    uint8_t segment = 0;    // Row the previous lookup ended on, the next search starts here
+
+    /**
+     * @brief Reads a key from the table
+     * 
+     * @param index Row to read
+     * @return Key of the row
+     */
+    Fixed16 keyAt(uint8_t index) const;
+
+  public:
+    /**
+     * @brief Defines a gain schedule from a PROGMEM table
+     * 
+     * @param progmemTable Table of rows declared with PROGMEM, in increasing key order
+     * @param tableSize Number of rows in the table (At least 1)
+     */
+    GainSchedule(const GainPoint *progmemTable, uint8_t tableSize);
+
+
+    /**
+     * @brief Looks up the gains for a value of the scheduling variable
+     * 
+     * @note Costs a few reads and multiplies plus one division, PidCommand only calls it when the variable changes
+     * 
+     * @param key Value of the scheduling variable
+     * @param gains Gains to fill in
+     */
+    void lookup(Fixed16 key, GainSet &gains);
+
+
+    /**
+     * @brief Gets the number of rows in the table
+     * 
+     * @return Number of rows
+     */
+    uint8_t getSize() const;
+};
+
+#endif // GAIN_SCHEDULE
@@ -0,0 +1,273 @@
+#include "PidAutoTuner.hpp"
+
+/* ------------------- PidAutoTuner Constructors ------------------- */
+
+template <class T>
+PidAutoTuner<T>::PidAutoTuner(BasicPidCommand<T> &pidCommand) {
+  command = &pidCommand;
+
+  // Relay defaults to the full output range
+  relayLow = command->outputRange[0];
+  relayHigh = command->outputRange[1];
+}
+
+/* ----------------------------------------------------------------- */
+
+
+
+/* --------------------- PidAutoTuner Methods ---------------------- */
+
+template <class T>
+void PidAutoTuner<T>::begin(T timestamp, uint8_t numCycles, T maxTime) {
+  cycles = numCycles > 0 ? numCycles : 1;
+  timeout = maxTime;
+
+  rises = 0;
+  measured = 0;
+  periodSum = 0;
+  amplitudeSum = 0;
+  ultimateGain = 0;
+  ultimatePeriod = 0;
+  kP = kI = kD = 0;
+
+  startTime = now = lastRise = timestamp;
+  lastMicros = TimeBase::read();
+  timeBase = false;
+  peakHigh = peakLow = *command->_input;
+
+  // Starts on the side that drives the input towards the setpoint
+  outputHigh = *command->_setpoint - *command->_input > 0;
+  *command->_output = outputHigh ? relayHigh : relayLow;
+
+  state = command->isStopped ? ABORTED : RUNNING;
+}
+
+
+template <class T>
+void PidAutoTuner<T>::begin(TimeMicros time, uint8_t numCycles, T maxTime) {
+  // Seconds are counted from the start, so Fixed16 times never get near their range
+  begin(T(0), numCycles, maxTime);
+  lastMicros = time;
+  timeBase = true;
+}
+
+
+template <class T>
+typename PidAutoTuner<T>::State PidAutoTuner<T>::update(T timestamp) {
+  if (state != RUNNING) {
+    return state;
+  }
+
+  // eStop() on the command always wins, it has already zeroed the output
+  if (command->isStopped) {
+    state = ABORTED;
+    return state;
+  }
+
+  now = timestamp;
+  T input = *command->_input;
+  T error = *command->_setpoint - input;
+
+  // Bounds on how long and how far the relay may drive the plant
+  if (timeout > 0 && now - startTime > timeout) {
+    finish(FAILED);
+    return state;
+  }
+  if (maxDeviation > 0 && (error > maxDeviation || error < -maxDeviation)) {
+    finish(FAILED);
+    return state;
+  }
+
+  // Extremes of the current oscillation
+  if (input > peakHigh) {
+    peakHigh = input;
+  }
+  if (input < peakLow) {
+    peakLow = input;
+  }
+
+  if (!outputHigh && error > hysteresis) {
+    outputHigh = true;
+
+    // A low to high switch ends a full oscillation, the first one is still settling and is skipped
+    if (rises >= 2) {
+      periodSum += now - lastRise;
+      amplitudeSum += (peakHigh - peakLow) * T(0.5);
+      measured++;
+    }
+
+    if (rises < 2) {
+      rises++;
+    }
+    lastRise = now;
+    peakHigh = peakLow = input;
+
+    if (measured >= cycles) {
+      computeGains();
+      return state;
+    }
+  } else if (outputHigh && error < -hysteresis) {
+    outputHigh = false;
+  }
+
+  *command->_output = outputHigh ? relayHigh : relayLow;
+  return state;
+}
+
+
+template <class T>
+typename PidAutoTuner<T>::State PidAutoTuner<T>::update() {
+  if (command->fixedRate) {
+    return update(now + command->fixedDeltaT);
+  } else if (command->timeFunc != nullptr) {
+    return update(command->timeFunc());
+  }
+  return update(TimeBase::read());
+}
+
+
+template <class T>
+typename PidAutoTuner<T>::State PidAutoTuner<T>::update(TimeMicros time) {
+  // Integer time since the last update, added to the seconds since the start
+  T change = TimeBase::toSeconds<T>(time - lastMicros);
+  lastMicros = time;
+  timeBase = true;
+
+  return update(now + change);
+}
+
+
+template <class T>
+void PidAutoTuner<T>::computeGains() {
+  T amplitude = amplitudeSum / T(measured);
+  ultimatePeriod = periodSum / T(measured);
+
+  if (!(amplitude > 0) || !(ultimatePeriod > 0)) {
+    finish(FAILED);
+    return;
+  }
+
+  // Describing function of a relay with amplitude d: Ku = 4d / (pi * a)
+  T relayAmplitude = (relayHigh - relayLow) * T(0.5);
+  ultimateGain = relayAmplitude * T(1.2732395) / amplitude;
+
+  switch (rule) {
+    case PI_ONLY:
+      kP = ultimateGain * T(0.45);
+      kI = ultimateGain * T(0.54) / ultimatePeriod;
+      kD = 0;
+      break;
+
+    case NO_OVERSHOOT:
+      kP = ultimateGain * T(0.2);
+      kI = ultimateGain * T(0.4) / ultimatePeriod;
+      kD = ultimateGain * ultimatePeriod * T(0.0666667);
+      break;
+
+    default:
+      kP = ultimateGain * T(0.6);
+      kI = ultimateGain * T(1.2) / ultimatePeriod;
+      kD = ultimateGain * ultimatePeriod * T(0.075);
+      break;
+  }
+
+  finish(DONE);
+}
+
+
+template <class T>
+void PidAutoTuner<T>::finish(State endState) {
+  state = endState;
+  *command->_output = 0;
+}
+
+
+template <class T>
+void PidAutoTuner<T>::abort() {
+  if (state == RUNNING) {
+    finish(ABORTED);
+  }
+}
+
+
+template <class T>
+void PidAutoTuner<T>::setRelay(T low, T high) {
+  relayLow = constrain(low, command->outputRange[0], command->outputRange[1]);
+  relayHigh = constrain(high, command->outputRange[0], command->outputRange[1]);
+}
+
+
+template <class T>
+void PidAutoTuner<T>::setHysteresis(T band) {
+  hysteresis = band;
+}
+
+
+template <class T>
+void PidAutoTuner<T>::setMaxDeviation(T deviation) {
+  maxDeviation = deviation;
+}
+
+
+template <class T>
+void PidAutoTuner<T>::setRule(Rule tuningRule) {
+  rule = tuningRule;
+}
+
+
+template <class T>
+typename PidAutoTuner<T>::State PidAutoTuner<T>::getState() {
+  return state;
+}
+
+
+template <class T>
+T PidAutoTuner<T>::getUltimateGain() {
+  return ultimateGain;
+}
+
+
+template <class T>
+T PidAutoTuner<T>::getUltimatePeriod() {
+  return ultimatePeriod;
+}
+
+
+template <class T>
+bool PidAutoTuner<T>::getGains(T &gainP, T &gainI, T &gainD) {
+  if (state != DONE) {
+    return false;
+  }
+
+  gainP = kP;
+  gainI = kI;
+  gainD = kD;
+  return true;
+}
+
+
+template <class T>
+bool PidAutoTuner<T>::apply() {
+  if (state != DONE) {
+    return false;
+  }
+
+  command->setGains(kP, kI, kD);
+  if (timeBase) {
+    command->reset(lastMicros);
+  } else {
+    command->reset(now);
+  }
+  return true;
+}
+
+/* ----------------------------------------------------------------- */
+
+
+
+/* ------------------ Backend Explicit Instantiation ------------------ */
+
+template class PidAutoTuner<double>;
+template class PidAutoTuner<Fixed16>;
+
+/* ----------------------------------------------------------------- */
@@ -0,0 +1,233 @@
+#ifndef PID_AUTO_TUNER
+#define PID_AUTO_TUNER
+
+#include <Arduino.h>
+#include "PidCommand.hpp"
+
+/*-----------------------------------------------------------------------------*/
+/** @file    PidAutoTuner.hpp
+  * @brief   Header for PidAutoTuner class (relay-feedback tuning of a PID command)
+*//*---------------------------------------------------------------------------*/
+
+
+/**
+ * @brief Class used to find PID gains for a PID command with the Åström–Hägglund relay method
+ * 
+ * @note While running, the tuner switches the command's output between two levels to make the input 
+ * oscillate around the setpoint. The period and amplitude of the oscillation give the ultimate gain and 
+ * period, and the gains are computed from those. Don't call calculate() on the command while tuning.
+ * 
+ * @tparam T Numeric type of the PID command (double, Fixed16, etc.)
+ */
+template <class T>
+class PidAutoTuner {
+  public:
+    /**
+     * @brief State of the tuner
+     */
+    enum State {
+      IDLE = 0, // Not started
+      RUNNING,  // Driving the relay and measuring cycles
+      DONE,     // Gains are ready
+      FAILED,   // Timed out, left the allowed deviation, or saw no oscillation
+      ABORTED   // Stopped by abort() or the command's eStop()
+    };
+
+
+    /**
+     * @brief Tuning rule used to turn the ultimate gain and period into gains
+     */
+    enum Rule {
+      CLASSIC_PID = 0, // Ziegler–Nichols PID (Fast, about 25% overshoot)
+      PI_ONLY,         // Ziegler–Nichols PI (No derivative term, for noisy inputs)
+      NO_OVERSHOOT     // Ziegler–Nichols no overshoot PID (Slower, smooth)
+    };
+
+  private:
+    BasicPidCommand<T> *command; // PID command being tuned
+
+    State state = IDLE;
+    Rule rule = CLASSIC_PID;
+
+    T relayLow = 0;       // Output while the input is above the setpoint
+    T relayHigh = 0;      // Output while the input is below the setpoint
+    T hysteresis = 0;     // Error needed to switch the relay, stops noise from switching it early
+    T maxDeviation = 0;   // Largest allowed error before failing (0 for no limit)
+    T timeout = 0;        // Longest time the tuner may run in seconds (0 for no limit)
+    uint8_t cycles = 0;   // Number of oscillations to average
+
+    bool outputHigh = false; // Current relay state
+    uint8_t rises = 0;       // Number of low to high relay switches so far
+    uint8_t measured = 0;    // Number of oscillations measured so far
+    T startTime = 0;         // Time the tuner started
+    T now = 0;               // Time of the latest update
+    TimeMicros lastMicros;   // Time base time of the latest update, when timed from the TimeBase
+    bool timeBase = false;   // Condition for if the tuner is timed from the TimeBase instead of timestamps in seconds
+    T lastRise = 0;          // Time of the last low to high relay switch
+    T peakHigh = 0;          // Largest input in the current oscillation
+    T peakLow = 0;           // Smallest input in the current oscillation
+    T periodSum = 0;         // Sum of the measured oscillation periods
+    T amplitudeSum = 0;      // Sum of the measured oscillation amplitudes
+
+    T ultimateGain = 0;      // Gain at which the loop would oscillate (Ku)
+    T ultimatePeriod = 0;    // Period of that oscillation in seconds (Tu)
+    T kP = 0;
+    T kI = 0;
+    T kD = 0;
+
+
+    /**
+     * @brief Ends the tuner and sets the output to 0
+     * 
+     * @param endState State to end in
+     */
+    void finish(State endState);
+
+
+    /**
+     * @brief Computes the ultimate gain and period and the gains from the measured oscillations
+     */
+    void computeGains();
+
+  public:
+    /**
+     * @brief Defines a tuner for a PID command
+     * 
+     * @param pidCommand PID command to tune, its input, output, setpoint, and output range are used
+     */
+    PidAutoTuner(BasicPidCommand<T> &pidCommand);
+
+
+    /**
+     * @brief Starts tuning around the current setpoint
+     * 
+     * @param timestamp Current time in seconds
+     * @param numCycles Number of oscillations to average, after one settling oscillation (Default 4)
+     * @param maxTime Longest time the tuner may run in seconds, 0 for no limit (Default 60)
+     */
+    void begin(T timestamp, uint8_t numCycles = 4, T maxTime = 60);
+
+
+    /**
+     * @brief Starts tuning around the current setpoint, timed from the TimeBase
+     * 
+     * @param time Current time (Such as TimeBase::now())
+     * @param numCycles Number of oscillations to average, after one settling oscillation (Default 4)
+     * @param maxTime Longest time the tuner may run in seconds, 0 for no limit (Default 60)
+     */
+    void begin(TimeMicros time, uint8_t numCycles = 4, T maxTime = 60);
+
+
+    /**
+     * @brief Runs one step of the tuner using a timestamp read by the caller
+     * 
+     * @param timestamp Current time in seconds
+     * @return State of the tuner after the step
+     */
+    State update(T timestamp);
+
+
+    /**
+     * @brief Runs one step of the tuner at a time base time read by the caller
+     * 
+     * @param time Current time (Such as TimeBase::now())
+     * @return State of the tuner after the step
+     */
+    State update(TimeMicros time);
+
+
+    /**
+     * @brief Runs one step of the tuner using the command's fixed period or timing function
+     * 
+     * @note Reads TimeBase::read() when the command has no timing function (Such as commands from PidExecutor)
+     * 
+     * @return State of the tuner after the step
+     */
+    State update();
+
+
+    /**
+     * @brief Stops the tuner and sets the output to 0
+     */
+    void abort();
+
+
+    /**
+     * @brief Sets the two relay outputs
+     * 
+     * @note Both are kept inside the command's output range, which they default to
+     * 
+     * @param low Output while the input is above the setpoint
+     * @param high Output while the input is below the setpoint
+     */
+    void setRelay(T low, T high);
+
+
+    /**
+     * @brief Sets the error needed to switch the relay
+     * 
+     * @param band Hysteresis band (Set it above the noise on the input)
+     */
+    void setHysteresis(T band);
+
+
+    /**
+     * @brief Sets the largest error allowed before the tuner fails
+     * 
+     * @param deviation Largest allowed error (0 for no limit)
+     */
+    void setMaxDeviation(T deviation);
+
+
+    /**
+     * @brief Sets the tuning rule used to compute the gains
+     * 
+     * @param tuningRule Tuning rule
+     */
+    void setRule(Rule tuningRule);
+
+
+    /**
+     * @brief Gets the state of the tuner
+     * 
+     * @return Current state
+     */
+    State getState();
+
+
+    /**
+     * @brief Gets the measured ultimate gain (Ku)
+     * 
+     * @return Ultimate gain, 0 until the tuner is done
+     */
+    T getUltimateGain();
+
+
+    /**
+     * @brief Gets the measured ultimate period (Tu)
+     * 
+     * @return Ultimate period in seconds, 0 until the tuner is done
+     */
+    T getUltimatePeriod();
+
+
+    /**
+     * @brief Gets the suggested gains
+     * 
+     * @param gainP Suggested proportional gain
+     * @param gainI Suggested integral gain
+     * @param gainD Suggested derivative gain
+     * @return Condition for if the tuner is done and the gains are valid
+     */
+    bool getGains(T &gainP, T &gainI, T &gainD);
+
+
+    /**
+     * @brief Sets the suggested gains on the PID command and resets it
+     * 
+     * @return Condition for if the gains were applied (False unless the tuner is done)
+     */
+    bool apply();
+};
+
+#endif // PID_AUTO_TUNER
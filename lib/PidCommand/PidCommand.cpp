@@ -1,11 +1,29 @@
 #include "PidCommand.hpp"
 
-/* -------------------- PidCommand Constructors -------------------- */
+/* ------------------ PidCommandBase Constructors ------------------ */
+
+int PidCommandBase::commands = 1;
+
+
+PidCommandBase::PidCommandBase() {
+  // PID Command ID
+  commandID = commands;
+  commands++;
+}
+
+
+int PidCommandBase::getCommandID() {
+  return commandID;
+}
+
+/* ----------------------------------------------------------------- */
 
-int PidCommand::commands = 1;
 
 
-PidCommand::PidCommand(double *in, double *out, double *set, double (&outRange)[2], double (*func)(), double kP, double kI, double kD) {
+/* -------------------- PidCommand Constructors -------------------- */
+
+template <class T>
+BasicPidCommand<T>::BasicPidCommand(T *in, T *out, T *set, T (&outRange)[2], T (*func)(), T kP, T kI, T kD) {
   // Control variable pointers
   _input = in;
   _output = out;
@@ -22,14 +40,11 @@ PidCommand::PidCommand(double *in, double *out, double *set, double (&outRange)[
   _kP = kP;
   _kI = kI;
   _kD = kD;
-
-  // PID Command ID
-  commandID = commands;
-  commands++;
 }
 
 
-PidCommand::PidCommand(double *in, double *out, double *set, double (*func)(), double kP, double kI, double kD) {
+template <class T>
+BasicPidCommand<T>::BasicPidCommand(T *in, T *out, T *set, T (*func)(), T kP, T kI, T kD) {
   // Control variable pointers
   _input = in;
   _output = out;
@@ -46,10 +61,6 @@ PidCommand::PidCommand(double *in, double *out, double *set, double (*func)(), d
   _kP = kP;
   _kI = kI;
   _kD = kD;
-
-  // PID Command ID
-  commandID = commands;
-  commands++;
 }
 
 /* ----------------------------------------------------------------- */
@@ -58,29 +69,98 @@ PidCommand::PidCommand(double *in, double *out, double *set, double (*func)(), d
 
 /* ----------------------- PidCommand Methods ---------------------- */
 
-void PidCommand::calculate() {
+template <class T>
+void BasicPidCommand<T>::calculate() {
+  if (fixedRate) {
+    step();
+  } else if (timeFunc != nullptr) {
+    calculate(timeFunc());
+  } else {
+    calculate(TimeBase::read());
+  }
+}
+
+
+template <class T>
+void BasicPidCommand<T>::calculate(T timestamp) {
+  // Time since the previous step, measured before it is used. The first step has no previous time, 
+  // so it runs with a dt of 0 instead of integrating everything since timestamp 0
+  setDeltaT(hasTimestamp ? timestamp - lastTimestamp : T(0));
+  lastTimestamp = timestamp;
+  hasTimestamp = true;
+
+  update();
+}
+
+
+template <class T>
+void BasicPidCommand<T>::calculate(TimeMicros now) {
+  // Integer time since the previous step, converted to seconds once. Like the timestamp path, the 
+  // first step only seeds the time, so setup and arming time before it isn't integrated
+  setDeltaT(hasMicros ? TimeBase::toSeconds<T>(now - lastMicros) : T(0));
+  lastMicros = now;
+  hasMicros = true;
+
+  update();
+}
+
+
+template <class T>
+void BasicPidCommand<T>::setDeltaT(T period) {
+  deltaT = period;
+  inverseDeltaT = deltaT > 0 ? T(1) / deltaT : T(0);
+  filterAlphaDeltaT = deltaT > 0 ? filterAlpha(deltaT) : T(1);
+}
+
+
+template <class T>
+void BasicPidCommand<T>::step() {
+  // Constant period, so the derivative never divides
+  deltaT = fixedDeltaT;
+  inverseDeltaT = fixedInverseDeltaT;
+  filterAlphaDeltaT = fixedFilterAlpha;
+  lastTimestamp += fixedDeltaT;
+
+  update();
+}
+
+
+template <class T>
+void BasicPidCommand<T>::update() {
   if (!isStopped) {
+    // Gains for the current operating point
+    if (schedule != nullptr) {
+      updateSchedule();
+    }
+
     // Proportional term 
     error = *_setpoint - *_input;
 
-    // Integral term 
-    if (absVal(error) < kIntegrationLimit) {
-      errorSum += error * deltaT;
-    } else {
-      errorSum = 0;
+    // Integral and derivative terms only exist once time has passed
+    if (deltaT > 0) {
+      // Derivative term, taken from the input so setpoint jumps don't kick the output
+      T rate = derivativeOnMeasurement
+        ? (lastInput - *_input) * inverseDeltaT
+        : (error - lastError) * inverseDeltaT;
+
+      // First-order low-pass filter on the derivative term
+      if (filterTimeConstant > 0) {
+        errorRate += filterAlphaDeltaT * (rate - errorRate);
+      } else {
+        errorRate = rate;
+      }
+
+      // Integral term 
+      integrate((_kP * error) + (_kD * errorRate) + feedforward);
     }
 
-    // Derivative term 
-    errorRate = (error - lastError) / deltaT;
-
     // Sets values for feedback loop
     lastError = error;
-    deltaT = timeFunc() - lastTimestamp;
-    lastTimestamp = timeFunc();
+    lastInput = *_input;
 
     // Output
     *_output = constrainOutput(
-      (_kP * error) + (_kI * errorSum) + (_kD * errorRate),
+      (_kP * error) + (_kI * errorSum) + (_kD * errorRate) + feedforward,
       outputRange
     );
   } else {
@@ -93,67 +173,242 @@ void PidCommand::calculate() {
   } else if (consoleOutput) {
     display();
   }
+
+  if (telemetryOutput) {
+    telemetry();
+  }
+}
+
+
+template <class T>
+void BasicPidCommand<T>::updateSchedule() {
+  T key = *scheduleVariable;
+
+  if (key == scheduleKey && !scheduleStale) {
+    return;
+  }
+
+  GainSet gains;
+  schedule->lookup(Fixed16(key), gains);
+
+  _kP = static_cast<T>(gains.kP);
+  _kI = static_cast<T>(gains.kI);
+  _kD = static_cast<T>(gains.kD);
+  feedforward = static_cast<T>(gains.feedforward);
+
+  scheduleKey = key;
+  scheduleStale = false;
+}
+
+
+template <class T>
+void BasicPidCommand<T>::integrate(T pdOutput) {
+  switch (antiWindup) {
+    case CLAMP: {
+      // Integrates unless the output is past a limit and the error pushes it further out
+      T candidate = errorSum + error * deltaT;
+      T unsaturated = pdOutput + (_kI * candidate);
+
+      if (!((unsaturated > outputRange[1] && error > 0) || (unsaturated < outputRange[0] && error < 0))) {
+        errorSum = candidate;
+      }
+      break;
+    }
+
+    case BACK_CALCULATION: {
+      // Feeds the amount the output is past its range back into the integral
+      T unsaturated = pdOutput + (_kI * errorSum);
+      T saturated = constrainOutput(unsaturated, outputRange);
+
+      errorSum += (error + trackingGain * (saturated - unsaturated)) * deltaT;
+      break;
+    }
+
+    default:
+      if (absVal(error) < kIntegrationLimit) {
+        errorSum += error * deltaT;
+      } else {
+        errorSum = 0;
+      }
+      break;
+  }
+}
+
+
+template <class T>
+T BasicPidCommand<T>::filterAlpha(T period) {
+  return filterTimeConstant > 0 ? period / (filterTimeConstant + period) : T(1);
+}
+
+
+template <class T>
+void BasicPidCommand<T>::setFixedRate(T period) {
+  fixedRate = period > 0;
+  fixedDeltaT = period;
+  fixedInverseDeltaT = fixedRate ? T(1) / period : T(0);
+  fixedFilterAlpha = fixedRate ? filterAlpha(period) : T(1);
+}
+
+
+template <class T>
+void BasicPidCommand<T>::setVariableRate() {
+  fixedRate = false;
+}
+
+
+template <class T>
+void BasicPidCommand<T>::reset(T timestamp) {
+  errorSum = 0;
+  errorRate = 0;
+  lastError = *_setpoint - *_input;
+  lastInput = *_input;
+  lastTimestamp = timestamp;
+  hasTimestamp = true;
+}
+
+
+template <class T>
+void BasicPidCommand<T>::reset(TimeMicros now) {
+  bool timestampSeeded = hasTimestamp;
+  reset(lastTimestamp);
+  hasTimestamp = timestampSeeded;
+  lastMicros = now;
+  hasMicros = true;
 }
 
 
-void PidCommand::setIntegrationLimit(double limit) {
+template <class T>
+void BasicPidCommand<T>::setIntegrationLimit(T limit) {
   kIntegrationLimit = limit;
 }
 
 
-void PidCommand::eStop() {
+template <class T>
+void BasicPidCommand<T>::setAntiWindup(AntiWindup mode, T gain) {
+  antiWindup = mode;
+  trackingGain = gain;
+}
+
+
+template <class T>
+void BasicPidCommand<T>::setDerivativeOnMeasurement(bool enabled) {
+  derivativeOnMeasurement = enabled;
+}
+
+
+template <class T>
+void BasicPidCommand<T>::setDerivativeFilter(T cutoffHz) {
+  // RC = 1 / (2 * pi * cutoff), computed here so a step only multiplies
+  filterTimeConstant = cutoffHz > 0 ? T(1) / (T(6.2831853) * cutoffHz) : T(0);
+  fixedFilterAlpha = fixedRate ? filterAlpha(fixedDeltaT) : T(1);
+}
+
+
+template <class T>
+void BasicPidCommand<T>::setGainSchedule(GainSchedule *gainSchedule, const T *variable) {
+  schedule = gainSchedule;
+  scheduleVariable = variable != nullptr ? variable : _setpoint;
+  scheduleStale = true;
+
+  // Without a schedule the gains from the last lookup stay, without the feedforward
+  if (schedule == nullptr) {
+    feedforward = 0;
+  }
+}
+
+
+template <class T>
+void BasicPidCommand<T>::setGains(T kP, T kI, T kD) {
+  _kP = kP;
+  _kI = kI;
+  _kD = kD;
+}
+
+
+template <class T>
+void BasicPidCommand<T>::setGains(const GainSet &gains) {
+  _kP = static_cast<T>(gains.kP);
+  _kI = static_cast<T>(gains.kI);
+  _kD = static_cast<T>(gains.kD);
+  feedforward = static_cast<T>(gains.feedforward);
+}
+
+
+template <class T>
+void BasicPidCommand<T>::getGains(GainSet &gains) {
+  gains.kP = Fixed16(_kP);
+  gains.kI = Fixed16(_kI);
+  gains.kD = Fixed16(_kD);
+  gains.feedforward = Fixed16(feedforward);
+}
+
+
+template <class T>
+void BasicPidCommand<T>::eStop() {
   isStopped = true;
   *_output = 0;
 }
 
 
-double PidCommand::getError() {
-  return error;
+template <class T>
+bool BasicPidCommand<T>::isEStopped() {
+  return isStopped;
 }
 
 
-double PidCommand::getErrorSum() {
-  return errorSum;
+template <class T>
+T BasicPidCommand<T>::getError() {
+  return error;
 }
 
 
-double PidCommand::getErrorRate() {
-  return errorRate;
+template <class T>
+T BasicPidCommand<T>::getErrorSum() {
+  return errorSum;
 }
 
 
-int PidCommand::getCommandID() {
-  return commandID;
+template <class T>
+T BasicPidCommand<T>::getErrorRate() {
+  return errorRate;
 }
 
 
-bool PidCommand::atSetpoint() {
+template <class T>
+bool BasicPidCommand<T>::atSetpoint() {
   return errorRate <= finishedValue;
 }
 
 
-bool PidCommand::atSetpoint(double threshold) {
+template <class T>
+bool BasicPidCommand<T>::atSetpoint(T threshold) {
   return errorRate <= threshold;
 }
 
 
-void PidCommand::setFinishedValue(double value) {
+template <class T>
+void BasicPidCommand<T>::setFinishedValue(T value) {
   finishedValue = value;
 }
 
 
-void PidCommand::setTimingFunction(double (*func)()) {
+template <class T>
+void BasicPidCommand<T>::setTimingFunction(T (*func)()) {
   timeFunc = func;
+  hasTimestamp = false; // A new clock, so its first reading only seeds the time
+  hasMicros = false;
 } 
 
 
-void PidCommand::sendConsoleOutput(bool sendOutput) {
+template <class T>
+void BasicPidCommand<T>::sendConsoleOutput(bool sendOutput) {
   consoleOutput = sendOutput;
   hasOutputMethod = false;
 }
 
 
-void PidCommand::sendConsoleOutput(void (*displayFunc)(), bool sendOutput) {
+template <class T>
+void BasicPidCommand<T>::sendConsoleOutput(void (*displayFunc)(), bool sendOutput) {
   displayMethod = displayFunc;
   consoleOutput = sendOutput;
 
@@ -161,44 +416,102 @@ void PidCommand::sendConsoleOutput(void (*displayFunc)(), bool sendOutput) {
 }
 
 
-void PidCommand::display() {
+template <class T>
+void BasicPidCommand<T>::display() {
+#if !(defined(IBUS_UART_ISR) && defined(__AVR__))
   // Prints the setpoint for comparison
   Serial.print(">Setpoint:");
-  Serial.println(*_setpoint);
+  Serial.println(static_cast<double>(*_setpoint));
 
   // Prints the error
   Serial.print(">Error:");
-  Serial.println(error * _kP);
+  Serial.println(static_cast<double>(error * _kP));
 
   // Prints the error sum
   Serial.print(">Error Sum:");
-  Serial.println(errorSum * _kI);
+  Serial.println(static_cast<double>(errorSum * _kI));
 
   // Prints the error rate
   Serial.print(">Error Rate:");
-  Serial.println(errorRate * _kD);
+  Serial.println(static_cast<double>(errorRate * _kD));
 
   // Prints the current position
   Serial.print(">Current Position:");
-  Serial.println(*_input);
+  Serial.println(static_cast<double>(*_input));
+#endif
 }
 
 
 template <class T>
-inline T PidCommand::constrainOutput(T x, T min, T max) {
+void BasicPidCommand<T>::sendTelemetry(bool sendOutput) {
+  telemetryOutput = sendOutput;
+}
+
+
+/**
+ * @brief Queues a PID telemetry record of floating-point values
+ */
+static bool sendPidRecord(uint8_t id, const double (&values)[6]) {
+  float sample[6];
+
+  for (uint8_t i = 0; i < 6; i++) {
+    sample[i] = values[i];
+  }
+
+  return Telemetry::send(Telemetry::PID, id, sample, 6);
+}
+
+
+/**
+ * @brief Queues a PID telemetry record of raw fixed-point values
+ */
+static bool sendPidRecord(uint8_t id, const Fixed16 (&values)[6]) {
+  int32_t sample[6];
+
+  for (uint8_t i = 0; i < 6; i++) {
+    sample[i] = values[i].getRaw();
+  }
+
+  return Telemetry::sendFixed(Telemetry::PID, id, sample, 6);
+}
+
+
+template <class T>
+bool BasicPidCommand<T>::telemetry() {
+  // Same values display() prints, in the same order
+  T values[6] = {*_setpoint, error * _kP, errorSum * _kI, errorRate * _kD, *_input, *_output};
+
+  return sendPidRecord(commandID, values);
+}
+
+
+template <class T>
+template <class V>
+inline V BasicPidCommand<T>::constrainOutput(V x, V min, V max) {
   return x >= min ? x <= max ? x : max : min;
 }
 
 
-template<class T>
-inline T PidCommand::constrainOutput(T x, T (&range)[2]) {
+template <class T>
+template <class V>
+inline V BasicPidCommand<T>::constrainOutput(V x, V (&range)[2]) {
   return constrain(x, range[0], range[1]);
 }
 
 
-template<class T>
-inline T PidCommand::absVal(T value) {
+template <class T>
+template <class V>
+inline V BasicPidCommand<T>::absVal(V value) {
   return value < 0 ? (value * -1) : value;
 }
 
+/* ----------------------------------------------------------------- */
+
+
+
+/* ------------------ Backend Explicit Instantiation ------------------ */
+
+template class BasicPidCommand<double>;
+template class BasicPidCommand<Fixed16>;
+
 /* ----------------------------------------------------------------- */
\ No newline at end of file
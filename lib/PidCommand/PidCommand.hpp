@@ -2,6 +2,10 @@
 #define PID_COMMAND
 
 #include <Arduino.h>
+#include <FixedPoint.hpp>
+#include <Telemetry.hpp>
+#include <TimeBase.hpp>
+#include "GainSchedule.hpp"
 
 /*-----------------------------------------------------------------------------*/
 /** @file    PidCommand.hpp
@@ -10,59 +14,160 @@
 
 
 /**
- * @brief Class used to create and control PID commands 
+ * @brief Shared state for every PID command regardless of its numeric type
  */
-class PidCommand {
-  private:
+class PidCommandBase {
+  protected:
     static int commands;      // Number of defined PID commands
     int commandID = 1;        // ID of the current PID command 
 
-    double _kP;               // Proportional gain
-    double _kI;               // Integral gain 
-    double _kD;               // Derivative gain 
+    /**
+     * @brief Assigns the next available command ID
+     */
+    PidCommandBase();
 
-    double *_input;           // Input variable pointer 
-    double *_output;          // Output variable pointer
-    double *_setpoint;        // Setpoint variable pointer
+  public:
+    /**
+     * @brief Ways of keeping the integral from winding up while the output is saturated
+     */
+    enum AntiWindup {
+      RESET = 0,       // Clears the integral while |error| is above the integration limit (Default)
+      CLAMP,           // Stops integrating while the output is saturated in the direction of the error
+      BACK_CALCULATION // Unwinds the integral by the amount the output exceeds the output range
+    };
 
-    double kIntegrationLimit; // Value of error to begin adding the integral term 
 
-    double finishedValue;     // Value of error rate for the PID command to be considered finished
-    
-    double error;             // Difference between setpoint and current value
-    double errorSum;          // Integral of the error with respect to time
-    double errorRate;         // Derivative of the error with respect to time
-    double lastError;         // Error from the previous iteration 
+    /**
+     * @brief Gets the ID of the current PID command 
+     * 
+     * @return The value of the current PID command ID
+     */
+    int getCommandID();
+};
+
+
+template <class T>
+class PidAutoTuner;
+
+
+/**
+ * @brief Class used to create and control PID commands 
+ * 
+ * @note Only the double and Fixed16 backends are instantiated in PidCommand.cpp
+ * 
+ * @tparam T Numeric type used for every value of the command (double, Fixed16, etc.)
+ */
+template <class T>
+class BasicPidCommand : public PidCommandBase {
+  friend class PidAutoTuner<T>; // Drives the output directly while tuning
+
+  private:
+    T _kP;                    // Proportional gain
+    T _kI;                    // Integral gain 
+    T _kD;                    // Derivative gain 
+
+    T *_input;                // Input variable pointer 
+    T *_output;               // Output variable pointer
+    T *_setpoint;             // Setpoint variable pointer
 
-    double deltaT;            // Time since last iteration 
-    double lastTimestamp;     // Current timestamp 
+    T kIntegrationLimit;      // Value of error to begin adding the integral term 
 
-    double minOutput;         // Minimum output of the PID command as a percentage 
-    double maxOutput;         // Maximum output of the PID command as a percentage
-    double outputRange[2];    // Output range for the PID command as percentages in the form {min, max}
+    T finishedValue;          // Value of error rate for the PID command to be considered finished
+    
+    T error = 0;              // Difference between setpoint and current value
+    T errorSum = 0;           // Integral of the error with respect to time
+    T errorRate = 0;          // Derivative of the error with respect to time
+    T lastError = 0;          // Error from the previous iteration 
+    T lastInput = 0;          // Input from the previous iteration 
+
+    AntiWindup antiWindup = RESET;   // Anti-windup mode used by the integral term
+    T trackingGain = 0;              // Back-calculation gain (errorSum unwound per second per unit of saturation)
+    bool derivativeOnMeasurement = false; // Condition for if the derivative term uses the input instead of the error
+    T filterTimeConstant = 0;        // Time constant of the derivative low-pass filter in seconds (0 is unfiltered)
+
+    T deltaT = 0;             // Time since last iteration 
+    T inverseDeltaT = 0;      // 1 / deltaT, so the derivative term multiplies instead of dividing
+    T lastTimestamp = 0;      // Current timestamp 
+    bool hasTimestamp = false; // Condition for if lastTimestamp holds a real time (The first timestamp only seeds it)
+    TimeMicros lastMicros;    // Time of the previous step when timed from the time base
+    bool hasMicros = false;   // Condition for if lastMicros holds a real time (The first time base step only seeds it)
+
+    bool fixedRate = false;   // Condition for if calculate() uses the fixed period instead of the timing function
+    T fixedDeltaT = 0;        // Fixed period between steps
+    T fixedInverseDeltaT = 0; // 1 / fixedDeltaT, computed once in setFixedRate()
+    T filterAlphaDeltaT = 1;  // Derivative filter coefficient for deltaT
+    T fixedFilterAlpha = 1;   // Derivative filter coefficient for fixedDeltaT, computed once when either changes
+
+    GainSchedule *schedule = nullptr; // Gain schedule to pick the gains from (nullptr for fixed gains)
+    const T *scheduleVariable = nullptr; // Value the gain schedule is keyed on
+    T scheduleKey = 0;        // Value of the scheduling variable when the gains were last looked up
+    bool scheduleStale = false; // Condition for if the gains need to be looked up regardless of the key
+    T feedforward = 0;        // Feedforward output from the gain schedule
+
+    T minOutput;              // Minimum output of the PID command as a percentage 
+    T maxOutput;              // Maximum output of the PID command as a percentage
+    T outputRange[2];         // Output range for the PID command as percentages in the form {min, max}
 
     bool isStopped = false; 
     bool consoleOutput = false;
     bool hasOutputMethod = false;
+    bool telemetryOutput = false;
 
-    double (*timeFunc)();     // Timing function of the PID command 
+    T (*timeFunc)();          // Timing function of the PID command 
     void (*displayMethod)();  // Method used to display output values if assigned
+
+
+    /**
+     * @brief Calculates the output using the current deltaT and inverseDeltaT
+     */
+    void update();
+
+
+    /**
+     * @brief Sets deltaT and the values computed from it for a step
+     * 
+     * @param period Time since the previous step in seconds
+     */
+    void setDeltaT(T period);
+
+
+    /**
+     * @brief Looks up the gains and feedforward if the scheduling variable has changed
+     */
+    void updateSchedule();
+
+
+    /**
+     * @brief Updates the integral term using the selected anti-windup mode
+     * 
+     * @param pdOutput Sum of the proportional, derivative, and feedforward terms of this iteration
+     */
+    void integrate(T pdOutput);
+
+
+    /**
+     * @brief Computes the derivative filter coefficient for a given period
+     * 
+     * @param period Time between steps in seconds
+     * @return Fraction of the new derivative kept each step (1 when unfiltered)
+     */
+    T filterAlpha(T period);
   public: 
     /**
      * @brief Defines a new PID command with a specified output range 
      * 
      * @note Defaults to just proportional control if no integral or derivative constants are given 
      * 
-     * @param in Pointer to a double for the input value 
-     * @param out Pointer to a double for the output value
-     * @param set Pointer to a double for the setpoint value 
+     * @param in Pointer to a value for the input value 
+     * @param out Pointer to a value for the output value
+     * @param set Pointer to a value for the setpoint value 
      * @param outRange Range of output values as percentages in the form {min, max}
-     * @param func Timing function for the PID command (Must return value in seconds)
+     * @param func Timing function for the PID command (Must return value in seconds, nullptr times steps from the TimeBase)
      * @param kP Propotional gain 
      * @param kI Integral gain (Defaults to 0)
      * @param kD Derivative gain (Defaults to 0)
      */
-    PidCommand(double *in, double *out, double *set, double (&outRange)[2], double (*func)(), double kP, double kI = 0, double kD = 0);
+    BasicPidCommand(T *in, T *out, T *set, T (&outRange)[2], T (*func)(), T kP, T kI = 0, T kD = 0);
 
 
     /**
@@ -70,29 +175,161 @@ class PidCommand {
      * 
      * @note Defaults to just proportional control if no integral or derivative constants are given 
      * 
-     * @param in Pointer to a double for the input value 
-     * @param out Pointer to a double for the output value 
-     * @param set Pointer to a double for the setpoint value
+     * @param in Pointer to a value for the input value 
+     * @param out Pointer to a value for the output value 
+     * @param set Pointer to a value for the setpoint value
      * @param func Timing function 
      * @param kP Proportional gain 
      * @param kI Integral gain (Default 0)
      * @param kD Derivative gain (Default 0)
      */
-    PidCommand(double *in, double *out, double *set, double (*func)(), double kP, double kI = 0, double kD = 0);
+    BasicPidCommand(T *in, T *out, T *set, T (*func)(), T kP, T kI = 0, T kD = 0);
 
 
     /**
      * @brief Calculates and sets the output value for the PID command 
+     * 
+     * @note Uses the fixed period if one is set, the timing function if one is given, and TimeBase::read() otherwise
      */
     void calculate();
 
 
+    /**
+     * @brief Calculates and sets the output value for the PID command at a time read by the caller
+     * 
+     * @note Preferred over calculate(timestamp), the time since the previous step is found with integer 
+     * math that stays correct across the micros() rollover, and only converted to seconds once
+     * 
+     * @param now Current time (Such as TimeBase::now())
+     */
+    void calculate(TimeMicros now);
+
+
+    /**
+     * @brief Calculates and sets the output value for the PID command using a timestamp read by the caller
+     * 
+     * @note Lets several PID commands share one time read per tick (See PidExecutor)
+     * 
+     * @param timestamp Current time in the same units as the timing function (Seconds)
+     */
+    void calculate(T timestamp);
+
+
+    /**
+     * @brief Calculates and sets the output value for the PID command using the fixed period
+     * 
+     * @note Meant to be called once per fixed-rate tick (See ControlTimer), no time is read and nothing is divided
+     */
+    void step();
+
+
+    /**
+     * @brief Switches the PID command to a fixed period between steps
+     * 
+     * @param period Time between steps in seconds (0 switches back to the timing function)
+     */
+    void setFixedRate(T period);
+
+
+    /**
+     * @brief Switches the PID command back to measuring time with the timing function
+     */
+    void setVariableRate();
+
+
+    /**
+     * @brief Clears the integral and derivative history and restarts timing from a timestamp
+     * 
+     * @param timestamp Time to measure the next step from
+     */
+    void reset(T timestamp);
+
+
+    /**
+     * @brief Clears the integral and derivative history and restarts timing from a time base time
+     * 
+     * @param now Time to measure the next step from (Such as TimeBase::now())
+     */
+    void reset(TimeMicros now);
+
+
     /**
      * @brief Sets the integration limit for the PID command
      * 
      * @param limit New integration limit
      */
-    void setIntegrationLimit(double limit);
+    void setIntegrationLimit(T limit);
+
+
+    /**
+     * @brief Sets how the integral term is kept from winding up
+     * 
+     * @note CLAMP and BACK_CALCULATION use the output range, so a large step keeps its integral 
+     * instead of losing it to the integration limit
+     * 
+     * @param mode Anti-windup mode (RESET, CLAMP, or BACK_CALCULATION)
+     * @param gain Tracking gain used by BACK_CALCULATION, 1 / sqrt(kI * kD) is a good start, or 1 / kP without a D term (Default 0)
+     */
+    void setAntiWindup(AntiWindup mode, T gain = 0);
+
+
+    /**
+     * @brief Sets whether the derivative term is taken from the input instead of the error
+     * 
+     * @note Removes the derivative kick when the setpoint jumps, such as from an RC switch
+     * 
+     * @param enabled Condition for if the derivative uses the input (Default true)
+     */
+    void setDerivativeOnMeasurement(bool enabled = true);
+
+
+    /**
+     * @brief Sets the cutoff of the first-order low-pass filter on the derivative term
+     * 
+     * @param cutoffHz Cutoff frequency in hertz (0 turns the filter off)
+     */
+    void setDerivativeFilter(T cutoffHz);
+
+
+    /**
+     * @brief Picks the gains and a feedforward output from a gain schedule every calculation
+     * 
+     * @note The table is only read when the scheduling variable changes, so a steady setpoint costs one comparison
+     * 
+     * @param gainSchedule Gain schedule to use (nullptr stops scheduling and keeps the last gains)
+     * @param variable Pointer to the scheduling variable (Defaults to nullptr, which uses the setpoint)
+     */
+    void setGainSchedule(GainSchedule *gainSchedule, const T *variable = nullptr);
+
+
+    /**
+     * @brief Sets the gains of the PID command
+     * 
+     * @note Overwritten on the next calculation while a gain schedule is set
+     * 
+     * @param kP Proportional gain
+     * @param kI Integral gain
+     * @param kD Derivative gain
+     */
+    void setGains(T kP, T kI, T kD);
+
+
+    /**
+     * @brief Sets the gains and feedforward from a gain set (Such as one kept in a ParamStore block)
+     * 
+     * @note Overwritten on the next calculation while a gain schedule is set
+     * 
+     * @param gains Gains and feedforward output
+     */
+    void setGains(const GainSet &gains);
+
+
+    /**
+     * @brief Gets the gains and feedforward in use, so they can be stored
+     * 
+     * @param gains Gain set to fill
+     */
+    void getGains(GainSet &gains);
 
     
     /**
@@ -103,12 +340,22 @@ class PidCommand {
     void eStop();
 
 
+    /**
+     * @brief Gets the condition for if the PID command has been stopped with eStop()
+     * 
+     * @note Used to trigger a SampleCapture when the command stops
+     * 
+     * @return Condition for if the command is stopped
+     */
+    bool isEStopped();
+
+
     /**
      * @brief Gets the error of the PID command 
      * 
      * @return The value of the error in the current iteration 
      */
-    double getError();
+    T getError();
 
 
     /**
@@ -116,7 +363,7 @@ class PidCommand {
      * 
      * @return The value of errorSum of the current iteration 
      */
-    double getErrorSum();
+    T getErrorSum();
 
 
     /**
@@ -124,15 +371,7 @@ class PidCommand {
      * 
      * @return The value of errorRate of the current iteration 
      */
-    double getErrorRate();
-
-
-    /**
-     * @brief Gets the ID of the current PID command 
-     * 
-     * @return The value of the current PID command ID
-     */
-    int getCommandID();
+    T getErrorRate();
 
 
     /**
@@ -149,7 +388,7 @@ class PidCommand {
      * @param threshold Threshold value for the PID command to be considered finished 
      * @return Condition for whether or not the PID command is at the setpoint
      */
-    bool atSetpoint(double threshold);
+    bool atSetpoint(T threshold);
 
 
     /**
@@ -157,7 +396,7 @@ class PidCommand {
      * 
      * @param value New finished value for the PID command 
      */
-    void setFinishedValue(double value);
+    void setFinishedValue(T value);
 
 
     /**
@@ -165,7 +404,7 @@ class PidCommand {
      * 
      * @param func Pointer to a function to call for timing 
      */
-    void setTimingFunction(double (*func)());
+    void setTimingFunction(T (*func)());
 
 
     /**
@@ -188,45 +427,68 @@ class PidCommand {
     /**
      * @brief Displays values to the Serial Plotter via VSC Teleplot extension
      * 
-     * @note Displays a graph of the setpoint, error, error sum, error rate, and current position
+     * @note Displays a graph of the setpoint, error, error sum, error rate, and current position. 
+     * Prints nothing with IBUS_UART_ISR, where the UART interrupts don't belong to Serial
      */
     void display();
 
 
+    /**
+     * @brief Sets whether or not the PID command sends a binary telemetry record every calculation
+     * 
+     * @note Records use Telemetry::PID with the command ID and are queued without blocking
+     * 
+     * @param sendOutput Condition for if the PID command sends telemetry (Default true)
+     */
+    void sendTelemetry(bool sendOutput = true);
+
+
+    /**
+     * @brief Queues a binary telemetry record of the setpoint, the P, I, and D terms, the input, and the output
+     * 
+     * @return Condition for if the record was queued (False if the telemetry buffer was full)
+     */
+    bool telemetry();
+
+
     /**
      * @brief Constrains a value between a minimum and maxium 
      * 
-     * @tparam T Data type of the value to be constrained (double, int, etc.)
+     * @tparam V Data type of the value to be constrained (double, int, etc.)
      * @param x Value to be constrained 
      * @param min Minimum value 
      * @param max Maximum value
      * @return Constrained value
      */
-    template <class T>
-    inline static T constrainOutput(T x, T min, T max);
+    template <class V>
+    inline static V constrainOutput(V x, V min, V max);
 
 
     /**
      * @brief Constrains a value between a minimum and maximum 
      * 
-     * @tparam T Data type of the value to be constrained (double, int, etc.)
+     * @tparam V Data type of the value to be constrained (double, int, etc.)
      * @param x Value to be contrained
      * @param range Range of values in the form {min, max}
      * @return Constrained value 
      */
-    template<class T> 
-    inline static T constrainOutput(T x, T (&range)[2]);
+    template<class V> 
+    inline static V constrainOutput(V x, V (&range)[2]);
 
 
     /**
      * @brief Takes in a number and returns its absolute value
      * 
-     * @tparam T Data type for the value
+     * @tparam V Data type for the value
      * @param value Number to get the absolute value of
-     * @return T Absolute value of the number 
+     * @return V Absolute value of the number 
      */
-    template <class T> 
-    inline static T absVal(T value);
+    template <class V> 
+    inline static V absVal(V value);
 };
 
+
+typedef BasicPidCommand<double> PidCommand;       // Floating-point PID command (Default)
+typedef BasicPidCommand<Fixed16> FixedPidCommand; // Q16.16 fixed-point PID command
+
 #endif // PID_COMMAND
\ No newline at end of file
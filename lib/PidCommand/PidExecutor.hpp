@@ -0,0 +1,260 @@
+#ifndef PID_EXECUTOR
+#define PID_EXECUTOR
+
+#include <Arduino.h>
+#include "PidCommand.hpp"
+
+#ifdef __AVR__
+#include <new.h>
+#else
+#include <new>
+#endif
+
+/*-----------------------------------------------------------------------------*/
+/** @file    PidExecutor.hpp
+  * @brief   Header for PidExecutor class (runs a fixed pool of PID commands)
+*//*---------------------------------------------------------------------------*/
+
+
+/**
+ * @brief Class used to own and step several PID commands from one shared timestamp
+ * 
+ * @note Controllers are constructed in place in static storage and always run in the order they were added
+ * 
+ * @tparam T Numeric type of the PID commands (double, Fixed16, etc.)
+ * @tparam N Maximum number of PID commands in the pool
+ */
+template <class T, uint8_t N>
+class PidExecutor {
+  private:
+    /**
+     * @brief Scheduling state of a controller in the pool
+     */
+    struct Slot {
+      uint8_t divisor;   // Number of ticks between runs of the controller
+      uint8_t countdown; // Ticks left until the controller runs again
+      bool enabled;      // Condition for if the controller runs
+      bool restart;      // Condition for if the controller restarts its timing on the next tick
+    };
+
+    alignas(BasicPidCommand<T>) uint8_t storage[N][sizeof(BasicPidCommand<T>)]; // Storage of the controllers
+    Slot slots[N];     // Scheduling state of each controller
+    uint8_t count = 0; // Number of controllers in the pool
+    T fixedPeriod = 0; // Time between ticks for fixed-rate stepping (0 when timestamps are used)
+
+
+    /**
+     * @brief Steps every enabled controller that is due this tick
+     * 
+     * @tparam Time Type of the timestamp (T in seconds, or TimeMicros)
+     * @param fixed Condition for if controllers step with their fixed period instead of the timestamp
+     * @param timestamp Current time (Unused when fixed)
+     */
+    template <class Time>
+    void run(bool fixed, Time timestamp) {
+      for (uint8_t i = 0; i < count; i++) {
+        Slot &slot = slots[i];
+
+        if (!slot.enabled) {
+          continue;
+        }
+
+        if (slot.restart) {
+          get(i)->reset(timestamp);
+          slot.restart = false;
+          slot.countdown = slot.divisor - 1;
+          continue;
+        }
+
+        if (slot.countdown == 0) {
+          if (fixed) {
+            get(i)->step();
+          } else {
+            get(i)->calculate(timestamp);
+          }
+          slot.countdown = slot.divisor - 1;
+        } else {
+          slot.countdown--;
+        }
+      }
+    }
+
+
+    /**
+     * @brief Gets the index of a controller from its command ID
+     * 
+     * @param commandID Command ID of the controller
+     * @return Index of the controller, or -1 if it isn't in the pool
+     */
+    int8_t indexOf(int commandID) {
+      for (uint8_t i = 0; i < count; i++) {
+        if (get(i)->getCommandID() == commandID) {
+          return i;
+        }
+      }
+      return -1;
+    }
+
+  public:
+    /**
+     * @brief Adds a PID command to the pool
+     * 
+     * @param in Pointer to the input value
+     * @param out Pointer to the output value
+     * @param set Pointer to the setpoint value
+     * @param outRange Range of output values in the form {min, max}
+     * @param kP Proportional gain
+     * @param kI Integral gain (Default 0)
+     * @param kD Derivative gain (Default 0)
+     * @param divisor Number of ticks between runs of the controller (Default 1, runs every tick)
+     * @return Pointer to the new PID command, or nullptr if the pool is full
+     */
+    BasicPidCommand<T>* add(T *in, T *out, T *set, T (&outRange)[2], T kP, T kI = 0, T kD = 0, uint8_t divisor = 1) {
+      if (count >= N) {
+        return nullptr;
+      }
+
+      BasicPidCommand<T> *command = new (storage[count]) BasicPidCommand<T>(in, out, set, outRange, nullptr, kP, kI, kD);
+
+      slots[count].divisor = divisor ? divisor : 1;
+      slots[count].countdown = 0;
+      slots[count].enabled = true;
+      slots[count].restart = true;
+      count++;
+
+      if (fixedPeriod > 0) {
+        command->setFixedRate(fixedPeriod * T(slots[count - 1].divisor));
+      }
+
+      return command;
+    }
+
+
+    /**
+     * @brief Steps every enabled controller that is due this tick
+     * 
+     * @note A controller that was just added or enabled only restarts its timing on its first tick
+     * 
+     * @param timestamp Current time in seconds, read once by the caller
+     */
+    void tick(T timestamp) {
+      run(false, timestamp);
+    }
+
+
+    /**
+     * @brief Steps every enabled controller that is due this tick from a time base time
+     * 
+     * @param now Current time, read once by the caller (Such as TimeBase::now())
+     */
+    void tick(TimeMicros now) {
+      run(false, now);
+    }
+
+
+    /**
+     * @brief Steps every enabled controller that is due this tick using the fixed period
+     * 
+     * @note Call once per ControlTimer tick after setFixedRate(), nothing is read or divided
+     */
+    void tick() {
+      run(true, TimeMicros());
+    }
+
+
+    /**
+     * @brief Sets the fixed time between ticks for tick() without a timestamp
+     * 
+     * @note Each controller steps with the period times its divisor
+     * 
+     * @param period Time between ticks in seconds
+     */
+    void setFixedRate(T period) {
+      fixedPeriod = period;
+
+      for (uint8_t i = 0; i < count; i++) {
+        get(i)->setFixedRate(period * T(slots[i].divisor));
+      }
+    }
+
+
+    /**
+     * @brief Enables or disables a controller
+     * 
+     * @param commandID Command ID of the controller
+     * @param enabled Condition for if the controller runs (Default true)
+     * @return Condition for if the controller was found
+     */
+    bool setEnabled(int commandID, bool enabled = true) {
+      int8_t index = indexOf(commandID);
+
+      if (index < 0) {
+        return false;
+      }
+
+      if (enabled && !slots[index].enabled) {
+        slots[index].restart = true;
+      }
+      slots[index].enabled = enabled;
+
+      return true;
+    }
+
+
+    /**
+     * @brief Sets the number of ticks between runs of a controller
+     * 
+     * @param commandID Command ID of the controller
+     * @param divisor Number of ticks between runs
+     * @return Condition for if the controller was found
+     */
+    bool setDivisor(int commandID, uint8_t divisor) {
+      int8_t index = indexOf(commandID);
+
+      if (index < 0) {
+        return false;
+      }
+
+      slots[index].divisor = divisor ? divisor : 1;
+      if (fixedPeriod > 0) {
+        get(index)->setFixedRate(fixedPeriod * T(slots[index].divisor));
+      }
+
+      return true;
+    }
+
+
+    /**
+     * @brief Finds a controller by its command ID
+     * 
+     * @param commandID Command ID of the controller
+     * @return Pointer to the PID command, or nullptr if it isn't in the pool
+     */
+    BasicPidCommand<T>* find(int commandID) {
+      int8_t index = indexOf(commandID);
+      return index < 0 ? nullptr : get(index);
+    }
+
+
+    /**
+     * @brief Gets a controller by its position in the pool
+     * 
+     * @param index Position of the controller (Order it was added in)
+     * @return Pointer to the PID command
+     */
+    BasicPidCommand<T>* get(uint8_t index) {
+      return reinterpret_cast<BasicPidCommand<T>*>(storage[index]);
+    }
+
+
+    /**
+     * @brief Gets the number of controllers in the pool
+     * 
+     * @return Number of controllers
+     */
+    uint8_t size() {
+      return count;
+    }
+};
+
+#endif // PID_EXECUTOR
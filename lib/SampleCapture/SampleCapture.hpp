@@ -0,0 +1,263 @@
+#ifndef SAMPLE_CAPTURE
+#define SAMPLE_CAPTURE
+
+#include <Arduino.h>
+#include <Telemetry.hpp>
+
+/*-----------------------------------------------------------------------------------------*/
+/** @file   SampleCapture.hpp
+ * @brief   Header for SampleCapture class (triggered ring buffer of int16 samples, dumped later)
+*//*---------------------------------------------------------------------------------------*/
+
+
+/**
+ * @brief Class used to record short transients at the full loop rate and send them once they are over
+ * 
+ * @note While armed, every record() call goes into a ring buffer, so the samples before the 
+ * trigger are kept. Once triggered, recording continues until the buffer holds preTrigger 
+ * samples from before the trigger and the rest from after it, then the capture is frozen. 
+ * dumpNext() sends one sample per call as a Telemetry CAPTURE record, so the dump can trickle 
+ * out over the serial link without blocking. A record() call is a copy of Channels values and 
+ * one comparison, so recording costs about the same whether or not anything happens.
+ * 
+ * @tparam Channels Number of int16 values in each sample (At most Telemetry::maxValues - 1)
+ * @tparam Depth Number of samples kept (Channels * Depth * 2 bytes of RAM)
+ */
+template <uint8_t Channels, uint16_t Depth>
+class SampleCapture {
+  static_assert(Channels > 0 && Channels < Telemetry::maxValues, "SampleCapture records need room for the offset value");
+  static_assert(Depth > 1, "SampleCapture needs at least 2 samples");
+
+  public:
+    /**
+     * @brief State of the capture
+     */
+    enum State : uint8_t {
+      IDLE = 0,  // Not recording
+      ARMED,     // Recording into the ring buffer and waiting for the trigger
+      TRIGGERED, // Recording the samples after the trigger
+      DONE       // Frozen until it is armed again
+    };
+
+    /**
+     * @brief Condition on one channel that triggers the capture
+     */
+    enum Condition : uint8_t {
+      NONE = 0,       // Only trigger() triggers
+      ABOVE,          // Value above the level
+      BELOW,          // Value below the level
+      MAGNITUDE_ABOVE // Absolute value above the level
+    };
+
+  private:
+    int16_t samples[Depth][Channels]; // Ring buffer of samples
+
+    uint16_t head = 0;          // Index the next sample is written to
+    uint16_t stored = 0;        // Number of samples written since arming (Up to Depth)
+    uint16_t preTrigger;        // Number of samples to keep from before the trigger
+    uint16_t keptBefore = 0;    // Number of samples from before the trigger in the capture
+    uint16_t remaining = 0;     // Samples still to record after the trigger
+    uint8_t decimation;         // Records every decimation-th call
+    uint8_t countdown = 1;      // Calls until the next sample is recorded
+    State state = IDLE;
+
+    uint8_t triggerChannel = 0;   // Channel the condition is checked on
+    Condition condition = NONE;   // Condition that triggers the capture
+    int16_t level = 0;            // Level of the condition
+    bool conditionMet = true;     // Condition for if the trigger condition held on the last check
+
+    uint16_t dumpPosition = 0;  // Next sample dumpNext() sends
+    uint8_t captures = 0;       // Number of captures finished, sent as the record ID
+
+  public:
+    /**
+     * @brief Defines a new capture, not armed yet
+     * 
+     * @param preTriggerSamples Number of samples to keep from before the trigger (At most Depth - 1)
+     * @param decimate Records every decimate-th call to record() (1 records every call)
+     */
+    SampleCapture(uint16_t preTriggerSamples = Depth / 4, uint8_t decimate = 1) {
+      preTrigger = preTriggerSamples < Depth ? preTriggerSamples : Depth - 1;
+      decimation = decimate > 0 ? decimate : 1;
+    }
+
+
+    /**
+     * @brief Clears the buffer and starts waiting for the trigger
+     * 
+     * @note A condition that already holds has to clear before it can trigger again
+     */
+    void arm() {
+      head = stored = keptBefore = dumpPosition = 0;
+      countdown = 1;
+      conditionMet = true;
+      state = ARMED;
+    }
+
+
+    /**
+     * @brief Stops recording and drops the capture
+     */
+    void disarm() {
+      state = IDLE;
+    }
+
+
+    /**
+     * @brief Sets the condition that triggers the capture
+     * 
+     * @note Checked on every record() call, including the ones decimation skips. The capture 
+     * triggers when the condition starts to hold, so a long event only triggers once.
+     * 
+     * @param channel Channel to check
+     * @param triggerCondition Condition on the channel (NONE to only trigger with trigger())
+     * @param triggerLevel Level to compare the channel with
+     */
+    void setTrigger(uint8_t channel, Condition triggerCondition, int16_t triggerLevel) {
+      triggerChannel = channel < Channels ? channel : 0;
+      condition = triggerCondition;
+      level = triggerLevel;
+    }
+
+
+    /**
+     * @brief Sets how many calls to record() there are per recorded sample
+     * 
+     * @param decimate Records every decimate-th call (1 records every call)
+     */
+    void setDecimation(uint8_t decimate) {
+      decimation = decimate > 0 ? decimate : 1;
+    }
+
+
+    /**
+     * @brief Triggers the capture (Such as from an eStop() or failsafe)
+     * 
+     * @note Does nothing unless armed, the next recorded sample is the first one after the trigger
+     */
+    void trigger() {
+      if (state != ARMED) {
+        return;
+      }
+
+      keptBefore = stored < preTrigger ? stored : preTrigger;
+      remaining = Depth - keptBefore;
+      state = TRIGGERED;
+    }
+
+
+    /**
+     * @brief Records a sample if the capture is running
+     * 
+     * @param sample Array of Channels values
+     * @return Condition for if the sample was stored
+     */
+    bool record(const int16_t sample[]) {
+      if (state != ARMED && state != TRIGGERED) {
+        return false;
+      }
+
+      if (state == ARMED) {
+        bool met = isTriggered(sample[triggerChannel]);
+        if (met && !conditionMet) {
+          trigger();
+        }
+        conditionMet = met;
+      }
+
+      if (--countdown != 0) {
+        return false;
+      }
+      countdown = decimation;
+
+      memcpy(samples[head], sample, sizeof(samples[0]));
+      head = head + 1 < Depth ? head + 1 : 0;
+      if (stored < Depth) {
+        stored++;
+      }
+
+      if (state == TRIGGERED && --remaining == 0) {
+        state = DONE;
+        captures++;
+      }
+
+      return true;
+    }
+
+
+    /**
+     * @brief Gets the state of the capture
+     * 
+     * @return State of the capture
+     */
+    State getState() {
+      return state;
+    }
+
+
+    /**
+     * @brief Gets a sample of a finished capture
+     * 
+     * @param index Index of the sample, 0 is the oldest (Up to Depth - 1)
+     * @param offset Set to the sample's position relative to the trigger (Negative before the trigger)
+     * @return Array of Channels values
+     */
+    const int16_t *getSample(uint16_t index, int16_t &offset) {
+      offset = (int16_t)index - (int16_t)keptBefore;
+
+      // Once full, the oldest sample is the one head points to
+      uint16_t position = head + index;
+      return samples[position < Depth ? position : position - Depth];
+    }
+
+
+    /**
+     * @brief Sends the next sample of a finished capture as a Telemetry CAPTURE record
+     * 
+     * @note The record values are the offset from the trigger followed by the channels, and the ID 
+     * is the number of the capture. If the telemetry buffer is full, the same sample is tried again 
+     * on the next call.
+     * 
+     * @return Condition for if samples are left to send
+     */
+    bool dumpNext() {
+      if (state != DONE || dumpPosition >= Depth) {
+        return false;
+      }
+
+      int16_t values[Channels + 1];
+      const int16_t *sample = getSample(dumpPosition, values[0]);
+      memcpy(&values[1], sample, sizeof(samples[0]));
+
+      if (Telemetry::send(Telemetry::CAPTURE, captures, values, Channels + 1)) {
+        dumpPosition++;
+      }
+
+      return dumpPosition < Depth;
+    }
+
+
+    /**
+     * @brief Gets the condition for if a finished capture has been sent completely
+     * 
+     * @return Condition for if dumpNext() has sent every sample
+     */
+    bool isDumped() {
+      return state == DONE && dumpPosition >= Depth;
+    }
+
+  private:
+    /**
+     * @brief Checks the trigger condition against a value
+     */
+    bool isTriggered(int16_t value) {
+      switch (condition) {
+        case ABOVE:           return value > level;
+        case BELOW:           return value < level;
+        case MAGNITUDE_ABOVE: return (value < 0 ? -(int32_t)value : (int32_t)value) > level;
+        default:              return false;
+      }
+    }
+};
+
+#endif // SAMPLE_CAPTURE
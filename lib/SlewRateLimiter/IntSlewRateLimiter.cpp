@@ -0,0 +1,99 @@
+#include "IntSlewRateLimiter.hpp"
+
+IntSlewRateLimiter::IntSlewRateLimiter(uint32_t maxChange) {
+  setRate(maxChange);
+
+  lastTime = TimeBase::read();
+}
+
+
+IntSlewRateLimiter::IntSlewRateLimiter(uint32_t maxPosChange, uint32_t maxNegChange) {
+  setRate(maxPosChange, maxNegChange);
+
+  lastTime = TimeBase::read();
+}
+
+
+int IntSlewRateLimiter::calculate(int targetValue) {
+  return calculate(targetValue, TimeBase::read());
+}
+
+
+int IntSlewRateLimiter::calculate(int targetValue, TimeMicros now) {
+  uint32_t timeChange = now - lastTime; // Stays correct across the micros() rollover
+  lastTime = now;
+
+  int32_t delta = ((int32_t)targetValue << valueFracBits) - lastValue;
+
+  // The remainder only carries while the rate limits, so time spent at the target doesn't build up a jump
+  if (delta > 0) { // Code to run to calculate change if the difference is positive
+    int32_t maxDelta = maxChange(increaseScaled, increaseLimit, timeChange, remainder);
+    if (delta > maxDelta) { delta = maxDelta; } else { remainder = 0; }
+  } else if (delta < 0) { // Code to run to calculate change if the difference is negative
+    int32_t maxDelta = maxChange(decreaseScaled, decreaseLimit, timeChange, remainder);
+    if (delta < -maxDelta) { delta = -maxDelta; } else { remainder = 0; }
+  } else {
+    remainder = 0;
+  }
+
+  lastValue += delta; // Add the change to the value 
+
+  // Rounds to the nearest whole value
+  return (lastValue + (1 << (valueFracBits - 1))) >> valueFracBits;
+}
+
+
+void IntSlewRateLimiter::setRate(uint32_t rate) {
+  setRate(rate, rate);
+}
+
+
+void IntSlewRateLimiter::setRate(uint32_t pos, uint32_t neg) {
+  increaseScaled = scaleRate(pos);
+  decreaseScaled = scaleRate(neg);
+
+  // Divisions happen here so calculate() never has to divide
+  increaseLimit = timeLimit(increaseScaled);
+  decreaseLimit = timeLimit(decreaseScaled);
+}
+
+
+void IntSlewRateLimiter::reset(int value) {
+  lastValue = (int32_t)value * ((int32_t)1 << valueFracBits);
+  remainder = 0;
+  lastTime = TimeBase::read();
+}
+
+
+Fixed16 IntSlewRateLimiter::getFixedValue() {
+  return Fixed16::fromRaw(lastValue * ((int32_t)1 << (Fixed16::fractionalBits - valueFracBits)));
+}
+
+
+uint32_t IntSlewRateLimiter::scaleRate(uint32_t rate) {
+  uint64_t scaled = (((uint64_t)rate << (valueFracBits + rateFracBits)) + 500000UL) / 1000000UL; // Rounded to the nearest
+  return scaled > maxScaled ? maxScaled : (uint32_t)scaled;
+}
+
+
+uint32_t IntSlewRateLimiter::timeLimit(uint32_t rateScaled) {
+  // Leaves room for the carried remainder on top of the product
+  return rateScaled ? (maxScaled - maxRemainder) / rateScaled : maxScaled;
+}
+
+
+int32_t IntSlewRateLimiter::maxChange(uint32_t rateScaled, uint32_t limit, uint32_t timeChange, uint16_t &carry) {
+  uint32_t change;
+
+  if (timeChange <= limit) { // Common case, a single 32 bit multiply
+    uint32_t scaled = rateScaled * timeChange + carry;
+    carry = (uint16_t)(scaled & maxRemainder);
+    change = scaled >> rateFracBits;
+  } else { // Long gaps between calls, far past any ramp so nothing is carried
+    uint64_t wide = ((uint64_t)rateScaled * timeChange + carry) >> rateFracBits;
+    carry = 0;
+    change = wide > (uint32_t)maxDeltaValue ? (uint32_t)maxDeltaValue : (uint32_t)wide;
+  }
+
+  return change > (uint32_t)maxDeltaValue ? maxDeltaValue : (int32_t)change;
+}
@@ -0,0 +1,150 @@
+#ifndef INT_SLEWRATE_LIMITER
+#define INT_SLEWRATE_LIMITER
+
+#include <Arduino.h>
+#include <TimeBase.hpp>
+#include <FixedPoint.hpp>
+
+/*-----------------------------------------------------------------------------------------*/
+/** @file   IntSlewRateLimiter.hpp
+ * @brief   Header for IntSlewRateLimiter class (integer-only SlewRateLimiter using micros())
+*//*---------------------------------------------------------------------------------------*/
+
+
+template <uint8_t N>
+class SlewRateLimiterBank;
+
+
+/**
+ * @brief Class used to limit the maximum amount an integer value changes per second without floating-point math
+ * 
+ * @note The value is kept with 8 fractional bits so slow ramps still move between calls, 
+ * and time is measured in microseconds with wraparound-safe unsigned differences. The part of 
+ * each allowed change below the value's fractional bits is carried to the next call, so the 
+ * rate doesn't depend on how often calculate() is called
+ */
+class IntSlewRateLimiter {
+  template <uint8_t N>
+  friend class SlewRateLimiterBank; // Shares the rate scaling
+
+  private:
+    static const uint8_t valueFracBits = 8;           // Fractional bits of the stored value
+    static const uint8_t rateFracBits = 16;           // Extra fractional bits of the scaled rates
+    static const uint32_t maxScaled = 0xFFFFFFFFUL;   // Largest unsigned 32 bit value
+    static const int32_t maxDeltaValue = 0x7FFFFFFFL; // Largest signed 32 bit value
+    static const uint32_t maxRemainder = ((uint32_t)1 << rateFracBits) - 1; // Largest carried remainder
+
+    uint32_t increaseScaled; // Maximum positive change per microsecond (value units << (valueFracBits + rateFracBits))
+    uint32_t decreaseScaled; // Maximum negative change per microsecond (value units << (valueFracBits + rateFracBits))
+    uint32_t increaseLimit;  // Largest time change that can be multiplied by increaseScaled without overflowing
+    uint32_t decreaseLimit;  // Largest time change that can be multiplied by decreaseScaled without overflowing
+    uint16_t remainder = 0;  // Allowed change below the value's fractional bits, carried while the rate limits
+
+    TimeMicros lastTime;     // Time of the previous iteration
+    int32_t lastValue = 0;   // Value at the previous iteration with valueFracBits fractional bits
+
+
+    /**
+     * @brief Converts a rate in units per second to the scaled per-microsecond rate 
+     * 
+     * @param rate Maximum change per second
+     * @return Scaled rate
+     */
+    static uint32_t scaleRate(uint32_t rate);
+
+
+    /**
+     * @brief Gets the maximum change allowed over a time change
+     * 
+     * @param rateScaled Scaled rate from scaleRate()
+     * @param limit Largest time change that doesn't overflow for the rate
+     * @param timeChange Time since the previous iteration in microseconds
+     * @param carry Remainder of the previous call, replaced with the remainder of this one
+     * @return Maximum change with valueFracBits fractional bits
+     */
+    static int32_t maxChange(uint32_t rateScaled, uint32_t limit, uint32_t timeChange, uint16_t &carry);
+
+
+    /**
+     * @brief Gets the largest time change maxChange() can take with a single 32 bit multiply
+     * 
+     * @param rateScaled Scaled rate from scaleRate()
+     * @return Largest time change in microseconds
+     */
+    static uint32_t timeLimit(uint32_t rateScaled);
+
+  public:
+    /**
+     * @brief Define a new IntSlewRateLimiter given the maximum change in either direction 
+     * 
+     * @param maxChange Maximum change per second
+     */
+    IntSlewRateLimiter(uint32_t maxChange);
+
+
+    /**
+     * @brief Define a new IntSlewRateLimiter given the maximum change in positive and negative directions
+     * 
+     * @param maxPosChange Maximum positive change per second
+     * @param maxNegChange Maximum negative change per second
+     */
+    IntSlewRateLimiter(uint32_t maxPosChange, uint32_t maxNegChange);
+
+
+    /**
+     * @brief Calculates the allowed change in value
+     * 
+     * @param targetValue Target value to reach
+     * @return The new value with the allowed amount of change 
+     */
+    int calculate(int targetValue);
+
+
+    /**
+     * @brief Calculates the allowed change in value at a time the caller has already read
+     * 
+     * @param targetValue Target value to reach
+     * @param now Current time (Such as TimeBase::now())
+     * @return The new value with the allowed amount of change 
+     */
+    int calculate(int targetValue, TimeMicros now);
+
+
+    /**
+     * @brief Sets the maximum rate of change
+     * 
+     * @param rate Maximum amount the value can change by per second
+     */
+    void setRate(uint32_t rate);
+
+    /**
+     * @brief Sets the maximum rate of change
+     * 
+     * @param pos Maximum positive change per second
+     * @param neg Maximum negative change per second
+     */
+    void setRate(uint32_t pos, uint32_t neg);
+
+
+    /**
+     * @brief Sets the current value without limiting and restarts timing from now
+     * 
+     * @note Keeps the limiter in step with a value that was set around it, so the next calculate() doesn't jump
+     * 
+     * @param value New current value
+     */
+    void reset(int value);
+
+
+    /**
+     * @brief Gets the current value with its fractional bits, before calculate() rounds it
+     * 
+     * @note Moves 1/256 of a unit at a time, so an output scaled from it is much finer than the whole value
+     * 
+     * @return Current value
+     */
+    Fixed16 getFixedValue();
+};
+
+
+#endif // INT_SLEWRATE_LIMITER
@@ -0,0 +1,91 @@
+#include "MotionProfile.hpp"
+
+const uint32_t MotionProfile::maxStep;
+
+
+MotionProfile::MotionProfile(Fixed16 rateLimit, Fixed16 rateChangeLimit) {
+  setLimits(rateLimit, rateChangeLimit);
+
+  lastTime = TimeBase::read();
+}
+
+
+int MotionProfile::calculate(int targetValue) {
+  return calculate(targetValue, TimeBase::read());
+}
+
+
+int MotionProfile::calculate(int targetValue, TimeMicros now) {
+  uint32_t timeChange = now - lastTime; // Stays correct across the micros() rollover
+  lastTime = now;
+
+  if (timeChange > maxStep) {
+    timeChange = maxStep;
+  }
+
+  // Seconds with 16 fractional bits, 8590 / 2^17 is 2^16 / 10^6 without a division. The part below
+  // one bit is carried to the next call so short periods don't drift
+  uint32_t scaledTime = timeChange * 8590UL + timeRemainder;
+  timeRemainder = scaledTime & 0x1FFFF;
+  Fixed16 deltaT = Fixed16::fromRaw((int32_t)(scaledTime >> 17));
+  Fixed16 error = Fixed16(targetValue) - value;
+
+  if (maxRateChange > 0) {
+    Fixed16 rateStep = maxRateChange * deltaT; // Largest change of the rate this call
+    Fixed16 speed = rate < 0 ? -rate : rate;
+    Fixed16 distance = error < 0 ? -error : error;
+
+    // Distance covered while bringing the rate back to 0, plus half a step for the discrete update
+    Fixed16 brakingDistance = speed * (speed * halfInverseChange) + speed * deltaT * Fixed16(0.5);
+
+    if (distance <= speed * deltaT && speed <= rateStep) {
+      // Close enough to land on the target this call
+      value = Fixed16(targetValue);
+      rate = 0;
+      return targetValue;
+    }
+
+    bool movingTowards = (rate > 0 && error > 0) || (rate < 0 && error < 0);
+    if (movingTowards && brakingDistance >= distance) {
+      // Brakes towards a rate of 0 without passing it
+      rate = speed <= rateStep ? Fixed16(0) : rate > 0 ? rate - rateStep : rate + rateStep;
+    } else {
+      // Speeds up towards the target, which also turns around a rate moving away from it
+      rate = error > 0 ? rate + rateStep : rate - rateStep;
+      rate = rate > maxRate ? maxRate : rate < -maxRate ? -maxRate : rate;
+    }
+
+    value += rate * deltaT;
+  } else {
+    // Straight ramp, the rate jumps to its limit
+    Fixed16 maxDelta = maxRate * deltaT;
+    Fixed16 delta = error > maxDelta ? maxDelta : error < -maxDelta ? -maxDelta : error;
+    rate = delta == error ? Fixed16(0) : delta > 0 ? maxRate : -maxRate;
+    value += delta;
+  }
+
+  // Rounds to the nearest whole value
+  return (value + Fixed16::fromRaw(Fixed16::one / 2)).toInt();
+}
+
+
+void MotionProfile::setLimits(Fixed16 rateLimit, Fixed16 rateChangeLimit) {
+  maxRate = rateLimit;
+  maxRateChange = rateChangeLimit;
+
+  // Division happens here so calculate() never has to divide
+  halfInverseChange = rateChangeLimit > 0 ? Fixed16(1) / (rateChangeLimit * Fixed16(2)) : Fixed16(0);
+}
+
+
+void MotionProfile::reset(int startValue) {
+  value = Fixed16(startValue);
+  rate = 0;
+  timeRemainder = 0;
+  lastTime = TimeBase::read();
+}
+
+
+Fixed16 MotionProfile::getRate() {
+  return rate;
+}
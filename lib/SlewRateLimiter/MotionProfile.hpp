@@ -0,0 +1,89 @@
+#ifndef MOTION_PROFILE
+#define MOTION_PROFILE
+
+#include <Arduino.h>
+#include <FixedPoint.hpp>
+#include <TimeBase.hpp>
+
+/*-----------------------------------------------------------------------------------------*/
+/** @file   MotionProfile.hpp
+ * @brief   Header for MotionProfile class (jerk-limited S-curve ramps using micros())
+*//*---------------------------------------------------------------------------------------*/
+
+
+/**
+ * @brief Class used to ramp an integer value with a limited rate of change and a limited change of that rate
+ * 
+ * @note For a belt speed, the rate is the belt acceleration and its change is the jerk. With a jerk limit 
+ * the value follows an S-curve, without one it ramps in straight lines like IntSlewRateLimiter. 
+ * Each call costs the same few Q16.16 multiplies, and a new target mid-ramp is followed from the current rate.
+ */
+class MotionProfile {
+  private:
+    static const uint32_t maxStep = 65535; // Longest time between calls that is used in microseconds (Longer gaps are treated as this)
+
+    Fixed16 value = 0;          // Current value
+    Fixed16 rate = 0;           // Current rate of change of the value per second
+    Fixed16 maxRate;            // Largest rate of change per second
+    Fixed16 maxRateChange;      // Largest change of the rate per second (0 for no limit)
+    Fixed16 halfInverseChange;  // 1 / (2 * maxRateChange), so the braking distance never divides
+
+    TimeMicros lastTime;        // Time of the previous iteration
+    uint32_t timeRemainder = 0; // Part of the time step below one fixed-point bit, carried to the next call
+
+  public:
+    /**
+     * @brief Defines a new MotionProfile starting at 0
+     * 
+     * @param rateLimit Largest change of the value per second (Acceleration for a speed)
+     * @param rateChangeLimit Largest change of the rate per second (Jerk for a speed, 0 for straight ramps)
+     */
+    MotionProfile(Fixed16 rateLimit, Fixed16 rateChangeLimit = 0);
+
+
+    /**
+     * @brief Calculates the next value of the ramp towards a target
+     * 
+     * @param targetValue Target value to reach (May change at any time)
+     * @return The new value, rounded to the nearest whole value
+     */
+    int calculate(int targetValue);
+
+
+    /**
+     * @brief Calculates the next value of the ramp at a time the caller has already read
+     * 
+     * @param targetValue Target value to reach (May change at any time)
+     * @param now Current time (Such as TimeBase::now())
+     * @return The new value, rounded to the nearest whole value
+     */
+    int calculate(int targetValue, TimeMicros now);
+
+
+    /**
+     * @brief Sets the limits of the ramp
+     * 
+     * @param rateLimit Largest change of the value per second
+     * @param rateChangeLimit Largest change of the rate per second (0 for straight ramps)
+     */
+    void setLimits(Fixed16 rateLimit, Fixed16 rateChangeLimit = 0);
+
+
+    /**
+     * @brief Sets the current value with a rate of 0 and restarts timing from now
+     * 
+     * @param startValue New current value
+     */
+    void reset(int startValue);
+
+
+    /**
+     * @brief Gets the current rate of change of the value
+     * 
+     * @return Rate of change per second
+     */
+    Fixed16 getRate();
+};
+
+
+#endif // MOTION_PROFILE
@@ -3,8 +3,7 @@
 SlewRateLimiter::SlewRateLimiter(double maxChange) {
   maxIncrease = maxDecrease = maxChange;
 
-  currentTime = millis();
-  lastTime = millis();
+  lastTime = TimeBase::read();
 }
 
 
@@ -12,26 +11,29 @@ SlewRateLimiter::SlewRateLimiter(double maxPosChange, double maxNegChange) {
   maxIncrease = maxPosChange;
   maxDecrease = maxNegChange;
 
-  currentTime = millis();
-  lastTime = millis();
+  lastTime = TimeBase::read();
 }
 
 
 double SlewRateLimiter::calculate(double targetValue) {
-  currentTime = millis();              // Get the current time
-  timeChange = currentTime - lastTime; // Measure the change in time 
+  return calculate(targetValue, TimeBase::read());
+}
+
+
+double SlewRateLimiter::calculate(double targetValue, TimeMicros now) {
+  double timeChange = TimeBase::toSeconds<double>(now - lastTime); // Wraparound-safe change in time
+  lastTime = now;
   delta = targetValue - lastValue;
 
   if (delta > 0) { // Code to run to calculate change if the difference is positive
-    maxDelta = maxIncrease * (timeChange / 1000.0); // Get the maximum positive change per second
+    maxDelta = maxIncrease * timeChange; // Get the maximum positive change
     delta = min(delta, maxDelta);
   } else if (delta < 0) { // Code to run to calculate change if the difference is negative
-    maxDelta = maxDecrease * (timeChange / 1000.0); // Get the maximum negative change per second
+    maxDelta = maxDecrease * timeChange; // Get the maximum negative change
     delta = max(delta, -maxDelta);
   }
 
-  lastValue += delta;  // Add the change to the value 
-  lastTime = millis(); // Record the time at the end of the current iteration
+  lastValue += delta; // Add the change to the value 
 
   return lastValue;
 }
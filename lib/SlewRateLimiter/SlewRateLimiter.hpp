@@ -2,6 +2,7 @@
 #define SLEWRATE_LIMITER
 
 #include <Arduino.h>
+#include <TimeBase.hpp>
 
 /*----------------------------------------------------------------------------------*/
 /** @file   SlewRateLimiter.hpp
@@ -17,11 +18,9 @@ class SlewRateLimiter {
     double maxIncrease; // Maximum positive change in the input per second
     double maxDecrease; // Maximum negative change in the input per second
 
-    double currentTime; // Current time value in milliseconds 
-    double lastTime;    // Time of the previous iteration
-    double timeChange;  // Change in time since previous iteration
+    TimeMicros lastTime; // Time of the previous iteration
 
-    double lastValue;   // Value of the number at the previous iteration
+    double lastValue = 0; // Value of the number at the previous iteration
     double maxDelta;    // Maximum change in the value since the previous iteration
     double delta;       // Change in the value since the previous iteration    
 
@@ -52,6 +51,16 @@ class SlewRateLimiter {
     double calculate(double targetValue);
 
 
+    /**
+     * @brief Calculates the allowed change in value at a time the caller has already read
+     * 
+     * @param targetValue Target value to reach
+     * @param now Current time (Such as TimeBase::now())
+     * @return The new value with the allowed amount of change 
+     */
+    double calculate(double targetValue, TimeMicros now);
+
+
     /**
      * @brief Sets the maximum rate of change
      * 
@@ -0,0 +1,147 @@
+#ifndef SLEWRATE_LIMITER_BANK
+#define SLEWRATE_LIMITER_BANK
+
+#include <Arduino.h>
+#include "IntSlewRateLimiter.hpp"
+
+/*-----------------------------------------------------------------------------------------*/
+/** @file   SlewRateLimiterBank.hpp
+ * @brief   Header for SlewRateLimiterBank class (several integer slew rate limiters sharing one time read)
+*//*---------------------------------------------------------------------------------------*/
+
+
+/**
+ * @brief Class used to limit how fast several integer values change, all stepped from one timestamp
+ * 
+ * @note Same math as IntSlewRateLimiter, with every field stored as its own array so one loop updates every channel
+ * 
+ * @tparam N Number of channels
+ */
+template <uint8_t N>
+class SlewRateLimiterBank {
+  private:
+    static const uint8_t valueFracBits = IntSlewRateLimiter::valueFracBits;
+
+    uint32_t increaseScaled[N]; // Maximum positive change per microsecond of each channel (See IntSlewRateLimiter)
+    uint32_t decreaseScaled[N]; // Maximum negative change per microsecond of each channel
+    uint32_t increaseLimit[N];  // Largest time change that can be multiplied by increaseScaled without overflowing
+    uint32_t decreaseLimit[N];  // Largest time change that can be multiplied by decreaseScaled without overflowing
+    int32_t values[N];          // Value of each channel with valueFracBits fractional bits
+    uint16_t remainders[N];     // Allowed change of each channel below valueFracBits, carried while the rate limits
+
+    TimeMicros lastTime;        // Time of the previous iteration
+
+  public:
+    /**
+     * @brief Defines a new bank with every channel at 0 and the same rate in both directions
+     * 
+     * @param maxChange Maximum change per second of every channel
+     */
+    SlewRateLimiterBank(uint32_t maxChange) {
+      for (uint8_t i = 0; i < N; i++) {
+        setRate(i, maxChange, maxChange);
+        values[i] = 0;
+        remainders[i] = 0;
+      }
+
+      lastTime = TimeBase::read();
+    }
+
+
+    /**
+     * @brief Limits every channel towards its target using one timestamp
+     * 
+     * @param targets Target value of each channel
+     * @param outputs Array of N values to fill with the limited value of each channel
+     * @param now Current time, read once by the caller (Such as TimeBase::now())
+     */
+    void calculate(const int targets[], int outputs[], TimeMicros now) {
+      uint32_t timeChange = now - lastTime; // Stays correct across the micros() rollover
+      lastTime = now;
+
+      for (uint8_t i = 0; i < N; i++) {
+        int32_t delta = (int32_t)targets[i] * ((int32_t)1 << valueFracBits) - values[i];
+
+        if (delta > 0) {
+          int32_t maxDelta = IntSlewRateLimiter::maxChange(increaseScaled[i], increaseLimit[i], timeChange, remainders[i]);
+          if (delta > maxDelta) { delta = maxDelta; } else { remainders[i] = 0; }
+        } else if (delta < 0) {
+          int32_t maxDelta = IntSlewRateLimiter::maxChange(decreaseScaled[i], decreaseLimit[i], timeChange, remainders[i]);
+          if (delta < -maxDelta) { delta = -maxDelta; } else { remainders[i] = 0; }
+        } else {
+          remainders[i] = 0;
+        }
+
+        values[i] += delta;
+
+        // Rounds to the nearest whole value
+        outputs[i] = (values[i] + (1 << (valueFracBits - 1))) >> valueFracBits;
+      }
+    }
+
+
+    /**
+     * @brief Limits every channel towards its target, reading micros() once
+     * 
+     * @param targets Target value of each channel
+     * @param outputs Array of N values to fill with the limited value of each channel
+     */
+    void calculate(const int targets[], int outputs[]) {
+      calculate(targets, outputs, TimeBase::read());
+    }
+
+
+    /**
+     * @brief Sets the maximum rate of change of a channel
+     * 
+     * @param channel Channel to set
+     * @param rate Maximum amount the value can change by per second
+     */
+    void setRate(uint8_t channel, uint32_t rate) {
+      setRate(channel, rate, rate);
+    }
+
+
+    /**
+     * @brief Sets the maximum rate of change of a channel in each direction
+     * 
+     * @param channel Channel to set
+     * @param pos Maximum positive change per second
+     * @param neg Maximum negative change per second
+     */
+    void setRate(uint8_t channel, uint32_t pos, uint32_t neg) {
+      increaseScaled[channel] = IntSlewRateLimiter::scaleRate(pos);
+      decreaseScaled[channel] = IntSlewRateLimiter::scaleRate(neg);
+
+      // Divisions happen here so calculate() never has to divide
+      increaseLimit[channel] = IntSlewRateLimiter::timeLimit(increaseScaled[channel]);
+      decreaseLimit[channel] = IntSlewRateLimiter::timeLimit(decreaseScaled[channel]);
+    }
+
+
+    /**
+     * @brief Sets the current value of a channel without limiting
+     * 
+     * @param channel Channel to set
+     * @param value New current value
+     */
+    void reset(uint8_t channel, int value) {
+      values[channel] = (int32_t)value * ((int32_t)1 << valueFracBits);
+      remainders[channel] = 0;
+    }
+
+
+    /**
+     * @brief Gets the current value of a channel
+     * 
+     * @param channel Channel to get
+     * @return Current value, rounded to the nearest whole value
+     */
+    int getValue(uint8_t channel) {
+      return (values[channel] + (1 << (valueFracBits - 1))) >> valueFracBits;
+    }
+};
+
+template <uint8_t N> const uint8_t SlewRateLimiterBank<N>::valueFracBits;
+
+#endif // SLEWRATE_LIMITER_BANK
@@ -0,0 +1,122 @@
+#include "TaskScheduler.hpp"
+#include <Telemetry.hpp>
+
+int8_t TaskScheduler::addTask(void (*function)(), uint32_t periodMicros, uint8_t priority) {
+  if (taskCount >= maxTasks) {
+    return -1;
+  }
+
+  Task &task = tasks[taskCount];
+  task.function = function;
+  task.period = periodMicros;
+  task.nextRun = micros();
+  task.priority = priority;
+  task.enabled = true;
+  task.stats = TaskStats();
+
+  return taskCount++;
+}
+
+
+bool TaskScheduler::run() {
+  uint32_t now = TimeBase::tick().getRaw();
+  Task *next = nullptr;
+
+  // Finds the highest priority task that is due (Ties go to the task added first)
+  for (uint8_t i = 0; i < taskCount; i++) {
+    Task &task = tasks[i];
+
+    if (task.enabled && (int32_t)(now - task.nextRun) >= 0) {
+      if (next == nullptr || task.priority < next->priority) {
+        next = &task;
+      }
+    }
+  }
+
+  if (next == nullptr) {
+    return false;
+  }
+
+  // Lateness of this run compared to when it was due
+  uint32_t jitter = now - next->nextRun;
+  next->stats.lastJitter = jitter;
+  if (jitter > next->stats.maxJitter) {
+    next->stats.maxJitter = jitter;
+  }
+
+  next->function();
+
+  uint32_t end = micros();
+  uint32_t runTime = end - now;
+  if (runTime > next->stats.maxRunTime) {
+    next->stats.maxRunTime = runTime;
+  }
+  next->stats.runs++;
+
+  // Keeps the schedule free of drift, but skips releases that were missed entirely
+  next->nextRun += next->period;
+  if ((int32_t)(end - next->nextRun) >= 0) {
+    next->stats.overruns++;
+    next->nextRun = end + next->period;
+  }
+
+  return true;
+}
+
+
+void TaskScheduler::setEnabled(int8_t id, bool enabled) {
+  if (id < 0 || id >= taskCount) {
+    return;
+  }
+
+  if (enabled && !tasks[id].enabled) {
+    tasks[id].nextRun = micros();
+  }
+  tasks[id].enabled = enabled;
+}
+
+
+void TaskScheduler::setPeriod(int8_t id, uint32_t periodMicros) {
+  if (id < 0 || id >= taskCount) {
+    return;
+  }
+
+  tasks[id].period = periodMicros;
+}
+
+
+const TaskStats& TaskScheduler::getStats(int8_t id) {
+  static const TaskStats emptyStats = TaskStats(); // Returned for an ID that isn't a task
+
+  if (id < 0 || id >= taskCount) {
+    return emptyStats;
+  }
+
+  return tasks[id].stats;
+}
+
+
+void TaskScheduler::resetStats() {
+  for (uint8_t i = 0; i < taskCount; i++) {
+    tasks[i].stats = TaskStats();
+  }
+}
+
+
+bool TaskScheduler::dumpNextStats() {
+  if (dumpPosition >= taskCount) {
+    dumpPosition = 0;
+    return false;
+  }
+
+  const TaskStats &stats = tasks[dumpPosition].stats;
+  int32_t values[5] = {
+    (int32_t)stats.runs, (int32_t)stats.overruns, (int32_t)stats.lastJitter, (int32_t)stats.maxJitter, (int32_t)stats.maxRunTime
+  };
+
+  if (Telemetry::send(Telemetry::TASK_STATS, dumpPosition, values, 5)) {
+    dumpPosition++;
+  }
+
+  return true;
+}
@@ -0,0 +1,125 @@
+#ifndef TASK_SCHEDULER
+#define TASK_SCHEDULER
+
+#include <Arduino.h>
+#include <TimeBase.hpp>
+
+/*-----------------------------------------------------------------------------*/
+/** @file   TaskScheduler.hpp
+ * @brief   Header for TaskScheduler class (cooperative fixed-period task runner)
+*//*---------------------------------------------------------------------------*/
+
+
+#ifndef TASK_SCHEDULER_MAX_TASKS
+#define TASK_SCHEDULER_MAX_TASKS 8 // Size of the static task table (Override with a build flag)
+#endif
+
+
+/**
+ * @brief Timing counters kept for every task
+ */
+struct TaskStats {
+  uint32_t runs;       // Number of times the task has run
+  uint32_t overruns;   // Number of times the task fell a full period or more behind its schedule
+  uint32_t lastJitter; // Lateness of the most recent run in microseconds
+  uint32_t maxJitter;  // Largest lateness seen in microseconds
+  uint32_t maxRunTime; // Longest run of the task in microseconds
+};
+
+
+/**
+ * @brief Class used to run functions at fixed periods without blocking the main loop
+ * 
+ * @note Tasks are stored in a static table, so nothing is allocated at runtime
+ */
+class TaskScheduler {
+  private:
+    /**
+     * @brief Entry in the task table
+     */
+    struct Task {
+      void (*function)(); // Function to run
+      uint32_t period;    // Time between runs in microseconds
+      uint32_t nextRun;   // Time the task is next due in microseconds
+      uint8_t priority;   // Priority of the task (Lower values run first)
+      bool enabled;       // Condition for if the task is allowed to run
+      TaskStats stats;    // Timing counters of the task
+    };
+
+    Task tasks[TASK_SCHEDULER_MAX_TASKS]; // Static task table
+    uint8_t taskCount = 0;                // Number of tasks in the table
+    uint8_t dumpPosition = 0;             // ID of the next task dumpNextStats() sends
+
+  public:
+    static const uint8_t maxTasks = TASK_SCHEDULER_MAX_TASKS; // Maximum number of tasks
+
+
+    /**
+     * @brief Adds a task to the scheduler
+     * 
+     * @param function Function to run
+     * @param periodMicros Time between runs in microseconds
+     * @param priority Priority of the task, lower values run first when several tasks are due (Default 0)
+     * @return ID of the task, or -1 if the task table is full
+     */
+    int8_t addTask(void (*function)(), uint32_t periodMicros, uint8_t priority = 0);
+
+
+    /**
+     * @brief Runs the highest priority task that is due
+     * 
+     * @note Call this from loop() as often as possible, a single call runs at most one task. Each call 
+     * ticks the TimeBase, so TimeBase::now() inside a task is the time it was dispatched at
+     * 
+     * @return Condition for if a task was run
+     */
+    bool run();
+
+
+    /**
+     * @brief Enables or disables a task
+     * 
+     * @note A task that is enabled again is due straight away
+     * 
+     * @param id ID of the task
+     * @param enabled Condition for if the task is allowed to run (Default true)
+     */
+    void setEnabled(int8_t id, bool enabled = true);
+
+
+    /**
+     * @brief Changes the period of a task
+     * 
+     * @param id ID of the task
+     * @param periodMicros New time between runs in microseconds
+     */
+    void setPeriod(int8_t id, uint32_t periodMicros);
+
+
+    /**
+     * @brief Gets the timing counters of a task
+     * 
+     * @param id ID of the task
+     * @return Timing counters of the task (All zero if the ID isn't a task, such as -1 from a full addTask())
+     */
+    const TaskStats& getStats(int8_t id);
+
+
+    /**
+     * @brief Clears the timing counters of every task
+     */
+    void resetStats();
+
+
+    /**
+     * @brief Sends the timing counters of the next task as a Telemetry TASK_STATS record
+     * 
+     * @note A task whose record doesn't fit in the telemetry buffer is sent again on the next call
+     * 
+     * @return Condition for if there are tasks left to send (False once every task has been sent, 
+     * the next call starts over)
+     */
+    bool dumpNextStats();
+};
+
+#endif // TASK_SCHEDULER
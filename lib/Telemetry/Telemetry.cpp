@@ -0,0 +1,223 @@
+#include "Telemetry.hpp"
+
+#if TELEMETRY_BUFFER_SIZE > 256 || (TELEMETRY_BUFFER_SIZE & (TELEMETRY_BUFFER_SIZE - 1)) != 0
+#error "TELEMETRY_BUFFER_SIZE must be a power of two no larger than 256"
+#endif
+
+#if defined(TELEMETRY_UART_ISR) && !defined(IBUS_UART_ISR)
+#error "TELEMETRY_UART_ISR needs IBUS_UART_ISR, polling Serial links HardwareSerial0, which defines USART_UDRE_vect as well"
+#endif
+
+uint8_t Telemetry::buffer[TELEMETRY_BUFFER_SIZE];
+volatile uint8_t Telemetry::head = 0;
+volatile uint8_t Telemetry::tail = 0;
+uint8_t Telemetry::sequence = 0;
+uint16_t Telemetry::dropped = 0;
+
+
+namespace {
+  /**
+   * @brief Adds a byte to a CRC-16/CCITT (Polynomial 0x1021, initial value 0xFFFF)
+   */
+  inline uint16_t crcUpdate(uint16_t crc, uint8_t data) {
+    crc ^= (uint16_t)data << 8;
+    for (uint8_t i = 0; i < 8; i++) {
+      crc = crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+    return crc;
+  }
+
+
+  /**
+   * @brief COBS encoder writing straight into the ring buffer
+   */
+  struct CobsWriter {
+    uint8_t *buffer;   // Ring buffer
+    uint8_t mask;      // Ring buffer index mask
+    uint8_t position;  // Index of the next byte
+    uint8_t codeIndex; // Index of the current code byte
+    uint8_t code;      // Distance from the code byte to the next zero
+    uint16_t crc;      // CRC of every byte written so far
+
+    CobsWriter(uint8_t *ring, uint8_t ringMask, uint8_t start) 
+      : buffer(ring), mask(ringMask), position((start + 1) & ringMask), codeIndex(start), code(1), crc(0xFFFF) {}
+
+    void put(uint8_t data, bool addToCrc = true) {
+      if (addToCrc) { crc = crcUpdate(crc, data); }
+
+      if (data == 0) {
+        finishBlock();
+        return;
+      }
+
+      buffer[position] = data;
+      position = (position + 1) & mask;
+      if (++code == 0xFF) {
+        finishBlock();
+      }
+    }
+
+    void finishBlock() {
+      buffer[codeIndex] = code;
+      codeIndex = position;
+      position = (position + 1) & mask;
+      code = 1;
+    }
+
+    uint8_t finish() {
+      buffer[codeIndex] = code;
+      buffer[position] = 0x00; // Record delimiter
+      return (position + 1) & mask;
+    }
+  };
+}
+
+
+bool Telemetry::queue(uint8_t type, uint8_t id, ValueFormat format, uint8_t count, const uint8_t *values, uint8_t valueSize) {
+  if (count > maxValues) {
+    count = maxValues;
+  }
+
+  // Worst case size: 9 byte header, values, 2 byte CRC, COBS overhead, and the delimiter
+  uint8_t rawLength = 9 + count * valueSize + 2;
+  uint8_t encodedLength = rawLength + rawLength / 254 + 2;
+  uint8_t used = (head - tail) & bufferMask;
+
+  if (encodedLength > bufferMask - used) {
+    dropped++;
+    sequence++; // Lets the decoder see the gap
+    return false;
+  }
+
+  uint32_t timestamp = micros();
+  CobsWriter writer(buffer, bufferMask, head);
+
+  writer.put(type);
+  writer.put(id);
+  writer.put(sequence++);
+  for (uint8_t i = 0; i < 4; i++) {
+    writer.put(timestamp >> (8 * i));
+  }
+  writer.put(format);
+  writer.put(count);
+  for (uint8_t i = 0; i < count * valueSize; i++) {
+    writer.put(values[i]);
+  }
+
+  uint16_t crc = writer.crc;
+  writer.put(crc & 0xFF, false);
+  writer.put(crc >> 8, false);
+
+  // Publishes the whole record at once so a partial record is never sent
+  head = writer.finish();
+
+#if defined(TELEMETRY_UART_ISR) && defined(__AVR__)
+  UCSR0B |= _BV(UDRIE0);
+#endif
+
+  return true;
+}
+
+
+bool Telemetry::send(uint8_t type, uint8_t id, const int16_t *values, uint8_t count) {
+  uint8_t wire[maxValues * 2];
+
+  for (uint8_t i = 0; i < count && i < maxValues; i++) {
+    wire[2 * i] = values[i] & 0xFF;
+    wire[2 * i + 1] = (uint16_t)values[i] >> 8;
+  }
+
+  return queue(type, id, ValueFormat::INT16, count, wire, 2);
+}
+
+
+bool Telemetry::send(uint8_t type, uint8_t id, const float *values, uint8_t count) {
+  uint8_t wire[maxValues * 4];
+
+  for (uint8_t i = 0; i < count && i < maxValues; i++) {
+    uint32_t bits;
+    memcpy(&bits, &values[i], sizeof(bits));
+
+    for (uint8_t b = 0; b < 4; b++) {
+      wire[4 * i + b] = bits >> (8 * b);
+    }
+  }
+
+  return queue(type, id, ValueFormat::FLOAT32, count, wire, 4);
+}
+
+
+bool Telemetry::send(uint8_t type, uint8_t id, const int32_t *values, uint8_t count) {
+  uint8_t wire[maxValues * 4];
+
+  for (uint8_t i = 0; i < count && i < maxValues; i++) {
+    for (uint8_t b = 0; b < 4; b++) {
+      wire[4 * i + b] = (uint32_t)values[i] >> (8 * b);
+    }
+  }
+
+  return queue(type, id, ValueFormat::INT32, count, wire, 4);
+}
+
+
+bool Telemetry::sendFixed(uint8_t type, uint8_t id, const int32_t *values, uint8_t count) {
+  uint8_t wire[maxValues * 4];
+
+  for (uint8_t i = 0; i < count && i < maxValues; i++) {
+    for (uint8_t b = 0; b < 4; b++) {
+      wire[4 * i + b] = (uint32_t)values[i] >> (8 * b);
+    }
+  }
+
+  return queue(type, id, ValueFormat::FIXED16, count, wire, 4);
+}
+
+
+bool Telemetry::nextByte(uint8_t &data) {
+  if (tail == head) {
+    return false;
+  }
+
+  data = buffer[tail];
+  tail = (tail + 1) & bufferMask;
+  return true;
+}
+
+
+uint16_t Telemetry::getDropped() {
+  return dropped;
+}
+
+
+uint8_t Telemetry::getQueued() {
+  return (head - tail) & bufferMask;
+}
+
+
+#if defined(TELEMETRY_UART_ISR) && defined(__AVR__)
+
+void Telemetry::poll() {}
+
+
+ISR(USART_UDRE_vect) {
+  uint8_t data;
+
+  if (Telemetry::nextByte(data)) {
+    UDR0 = data;
+  } else {
+    UCSR0B &= ~_BV(UDRIE0); // Nothing left, stops the interrupt until the next record
+  }
+}
+
+#else
+
+void Telemetry::poll() {
+  uint8_t data;
+  int space = Serial.availableForWrite();
+
+  while (space-- > 0 && nextByte(data)) {
+    Serial.write(data);
+  }
+}
+
+#endif
@@ -0,0 +1,166 @@
+#ifndef TELEMETRY
+#define TELEMETRY
+
+#include <Arduino.h>
+
+/*-----------------------------------------------------------------------------*/
+/** @file   Telemetry.hpp
+ * @brief   Header for Telemetry class (non-blocking framed binary telemetry)
+*//*---------------------------------------------------------------------------*/
+
+
+#ifndef TELEMETRY_BUFFER_SIZE
+#define TELEMETRY_BUFFER_SIZE 128 // Size of the transmit ring buffer in bytes (Power of two, at most 256)
+#endif
+
+
+/**
+ * @brief Class used to send samples as compact binary records without blocking
+ * 
+ * @note Each record is: type, id, sequence, timestamp (uint32 us), format, count, values, CRC-16/CCITT.
+ * Multi-byte fields are little-endian. The record is COBS encoded and ends with a 0x00 delimiter, 
+ * then queued whole in a ring buffer. If the record doesn't fit, it is dropped and counted instead 
+ * of waiting for space. tools/telemetry_decode.py turns the stream back into Teleplot lines or CSV.
+ * 
+ * With the TELEMETRY_UART_ISR build flag on an AVR board, the ring buffer is drained by the 
+ * USART data register empty interrupt. Any use of Serial links HardwareSerial0, which defines 
+ * USART_UDRE_vect too, so it needs IBUS_UART_ISR as well and the sketch must not use Serial 
+ * (See the uno_isr environment). Without the flag, poll() moves as many bytes as HardwareSerial 
+ * can take without blocking. Nothing else may print text on the port either way, since it would 
+ * land between records; diagnostics are sent as records instead.
+ */
+class Telemetry {
+  public:
+    /**
+     * @brief Record types known to the host decoder
+     */
+    enum RecordType : uint8_t {
+      PID = 1,      // PID command sample (setpoint, P, I, D, input, output), id is the command ID
+      MOTOR = 2,    // Motor output (output, percent)
+      CHANNELS = 3, // Raw RC channels, indexed by ChannelRC
+      PARAM = 4,    // Response to a TuningLink request (command, status, values), id is the parameter ID
+      CAPTURE = 5,  // SampleCapture sample (offset from the trigger, channels), id is the capture number
+      TASK_STATS = 6,        // TaskScheduler counters (runs, overruns, last jitter, max jitter, max run time), id is the task ID
+      PROFILE = 7,           // LoopProfiler stage timings (count, min, max, overruns, budget), id is the stage
+      PROFILE_HISTOGRAM = 8, // LoopProfiler stage histogram (One count per bucket), id is the stage
+      USER = 16     // First type free for other records
+    };
+
+    /**
+     * @brief Encoding of the values in a record
+     */
+    enum ValueFormat : uint8_t {
+      INT16 = 0,   // Signed 16 bit integers
+      FLOAT32 = 1, // IEEE 754 single precision floats
+      FIXED16 = 2, // Signed 32 bit Q16.16 fixed-point values
+      INT32 = 3    // Signed 32 bit integers
+    };
+
+    static const uint8_t maxValues = 16; // Maximum number of values in a record
+
+  private:
+    static const uint8_t bufferMask = TELEMETRY_BUFFER_SIZE - 1; // Highest ring buffer index (Used as a mask)
+
+    static uint8_t buffer[TELEMETRY_BUFFER_SIZE]; // Ring buffer of encoded records
+    static volatile uint8_t head;                 // Index the next byte is written to
+    static volatile uint8_t tail;                 // Index the next byte is sent from
+    static uint8_t sequence;                      // Sequence number of the next record
+    static uint16_t dropped;                      // Number of records dropped because the buffer was full
+
+
+    /**
+     * @brief Encodes a record and queues it in the ring buffer
+     * 
+     * @param type Type of the record
+     * @param id ID of the source of the record
+     * @param format Encoding of the values
+     * @param count Number of values
+     * @param values Values already in their little-endian wire encoding
+     * @param valueSize Size of a single value in bytes
+     * @return Condition for if the record was queued
+     */
+    static bool queue(uint8_t type, uint8_t id, ValueFormat format, uint8_t count, const uint8_t *values, uint8_t valueSize);
+
+  public:
+    /**
+     * @brief Sends a record of 16 bit integers
+     * 
+     * @param type Type of the record
+     * @param id ID of the source of the record
+     * @param values Values to send
+     * @param count Number of values (At most maxValues)
+     * @return Condition for if the record was queued
+     */
+    static bool send(uint8_t type, uint8_t id, const int16_t *values, uint8_t count);
+
+
+    /**
+     * @brief Sends a record of floats
+     * 
+     * @param type Type of the record
+     * @param id ID of the source of the record
+     * @param values Values to send
+     * @param count Number of values (At most maxValues)
+     * @return Condition for if the record was queued
+     */
+    static bool send(uint8_t type, uint8_t id, const float *values, uint8_t count);
+
+
+    /**
+     * @brief Sends a record of 32 bit integers
+     * 
+     * @param type Type of the record
+     * @param id ID of the source of the record
+     * @param values Values to send
+     * @param count Number of values (At most maxValues)
+     * @return Condition for if the record was queued
+     */
+    static bool send(uint8_t type, uint8_t id, const int32_t *values, uint8_t count);
+
+
+    /**
+     * @brief Sends a record of raw Q16.16 fixed-point values
+     * 
+     * @param type Type of the record
+     * @param id ID of the source of the record
+     * @param values Raw values to send
+     * @param count Number of values (At most maxValues)
+     * @return Condition for if the record was queued
+     */
+    static bool sendFixed(uint8_t type, uint8_t id, const int32_t *values, uint8_t count);
+
+
+    /**
+     * @brief Sends queued bytes without blocking
+     * 
+     * @note Does nothing when the transmit interrupt drains the buffer
+     */
+    static void poll();
+
+
+    /**
+     * @brief Gets the number of records dropped because the buffer was full
+     * 
+     * @return Number of dropped records
+     */
+    static uint16_t getDropped();
+
+
+    /**
+     * @brief Gets the number of bytes waiting to be sent
+     * 
+     * @return Number of queued bytes
+     */
+    static uint8_t getQueued();
+
+
+    /**
+     * @brief Sends the next queued byte (Called from the transmit interrupt)
+     * 
+     * @param data Set to the byte to send
+     * @return Condition for if there was a byte to send
+     */
+    static bool nextByte(uint8_t &data);
+};
+
+#endif // TELEMETRY
@@ -0,0 +1,17 @@
+#include "TimeBase.hpp"
+
+TimeMicros TimeBase::tickTime;
+
+
+bool TimeBase::periodElapsed(TimeMicros &next, uint32_t period) {
+  if (tickTime.isBefore(next)) {
+    return false;
+  }
+
+  next += period;
+  if (!tickTime.isBefore(next)) {
+    next = tickTime + period;
+  }
+
+  return true;
+}
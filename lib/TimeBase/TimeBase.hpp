@@ -0,0 +1,169 @@
+#ifndef TIME_BASE
+#define TIME_BASE
+
+#include <Arduino.h>
+#include <FixedPoint.hpp>
+
+/*-----------------------------------------------------------------------------*/
+/** @file   TimeBase.hpp
+ * @brief   Header for TimeBase class (shared wraparound-safe microsecond time)
+*//*---------------------------------------------------------------------------*/
+
+
+/**
+ * @brief Point in time in microseconds, as read from micros()
+ * 
+ * @note micros() wraps every 71.6 minutes (millis() every 49.7 days), so two times can't be ordered 
+ * by comparing them. Subtracting gives the unsigned time between them, which stays correct across 
+ * the wrap as long as they are less than 71.6 minutes apart. isBefore() compares through that difference.
+ */
+class TimeMicros {
+  private:
+    uint32_t ticks; // Value of micros()
+
+  public:
+    /**
+     * @brief Defines a time of 0
+     */
+    TimeMicros() : ticks(0) {}
+
+
+    /**
+     * @brief Defines a time from a micros() value
+     * 
+     * @param value Time in microseconds
+     */
+    explicit TimeMicros(uint32_t value) : ticks(value) {}
+
+
+    /**
+     * @brief Gets the micros() value of the time
+     * 
+     * @return Time in microseconds
+     */
+    inline uint32_t getRaw() const { return ticks; }
+
+
+    /**
+     * @brief Gets the condition for if the time is before another one (Within 35.8 minutes of it)
+     * 
+     * @param other Time to compare with
+     * @return Condition for if this time comes first
+     */
+    inline bool isBefore(TimeMicros other) const { return (int32_t)(ticks - other.ticks) < 0; }
+
+
+    /* ------------------------ Arithmetic ------------------------- */
+
+    friend inline uint32_t operator-(TimeMicros later, TimeMicros earlier) { return later.ticks - earlier.ticks; }
+    friend inline TimeMicros operator+(TimeMicros time, uint32_t change) { return TimeMicros(time.ticks + change); }
+    inline TimeMicros& operator+=(uint32_t change) { ticks += change; return *this; }
+
+    friend inline bool operator==(TimeMicros a, TimeMicros b) { return a.ticks == b.ticks; }
+    friend inline bool operator!=(TimeMicros a, TimeMicros b) { return a.ticks != b.ticks; }
+};
+
+
+/**
+ * @brief Class used to share one time read per loop pass between every library
+ * 
+ * @note Call tick() at the start of loop(), then pass now() to every calculate() in that pass, so they 
+ * all step from the same time and micros() is read once. read() gives a fresh time instead. On the 
+ * host, micros() is the fake clock, so FakeClock::setMicros() can start a test right before the wrap.
+ */
+class TimeBase {
+  private:
+    static TimeMicros tickTime; // Time read by the last tick()
+
+  public:
+    /**
+     * @brief Reads the current time
+     * 
+     * @return Current time
+     */
+    static inline TimeMicros read() { return TimeMicros(micros()); }
+
+
+    /**
+     * @brief Reads the time for this loop pass
+     * 
+     * @return Time read
+     */
+    static inline TimeMicros tick() { return tickTime = read(); }
+
+
+    /**
+     * @brief Gets the time read by the last tick()
+     * 
+     * @return Time of this loop pass
+     */
+    static inline TimeMicros now() { return tickTime; }
+
+
+    /**
+     * @brief Gets the time from a past time to the time of this loop pass
+     * 
+     * @param since Earlier time
+     * @return Time passed in microseconds
+     */
+    static inline uint32_t elapsed(TimeMicros since) { return tickTime - since; }
+
+
+    /**
+     * @brief Gets the condition for if the time of this loop pass has reached a deadline
+     * 
+     * @param deadline Time to check
+     * @return Condition for if the deadline has passed or is now
+     */
+    static inline bool reached(TimeMicros deadline) { return !tickTime.isBefore(deadline); }
+
+
+    /**
+     * @brief Checks a fixed period and moves its deadline forward once it is reached
+     * 
+     * @note The deadline moves by exactly one period so the average rate doesn't drift. If it has 
+     * fallen more than a period behind, it restarts from now instead of running several times in a row.
+     * 
+     * @param next Deadline of the next run, updated when it is reached
+     * @param period Period in microseconds
+     * @return Condition for if the period has passed
+     */
+    static bool periodElapsed(TimeMicros &next, uint32_t period);
+
+
+    /**
+     * @brief Converts a time change in microseconds to seconds
+     * 
+     * @tparam T Numeric type of the result (double or Fixed16)
+     * @param change Time change in microseconds
+     * @return Time change in seconds
+     */
+    template <class T>
+    static inline T toSeconds(uint32_t change) { return T(change * 1e-6); }
+};
+
+
+/**
+ * @brief Converts to Q16.16 seconds with four 16x16->32 bit multiplies (No 64-bit library math on AVR)
+ * 
+ * @note Takes the upper 32 bits of change * 281474977, where 281474977 / 2^32 is 65536 / 10^6 to 1 part 
+ * in 10^9. The result is floor(change * 65536 / 10^6), or one bit (15 ns) above it.
+ */
+template <>
+inline Fixed16 TimeBase::toSeconds<Fixed16>(uint32_t change) {
+  const uint16_t scaleHigh = 4294;  // Upper half of 281474977
+  const uint16_t scaleLow = 63393;  // Lower half of 281474977
+  uint16_t changeHigh = change >> 16;
+  uint16_t changeLow = change & 0xFFFF;
+
+  // Partial products, the middle ones are added through their halves so no sum overflows 32 bits
+  uint32_t lowProduct = (uint32_t)changeLow * scaleLow;
+  uint32_t crossLow = (uint32_t)changeLow * scaleHigh + (lowProduct >> 16); // Below 2^29
+  uint32_t crossHigh = (uint32_t)changeHigh * scaleLow;
+  uint32_t middle = (crossLow & 0xFFFF) + (crossHigh & 0xFFFF);
+
+  uint32_t raw = (uint32_t)changeHigh * scaleHigh + (crossLow >> 16) + (crossHigh >> 16) + (middle >> 16);
+  return Fixed16::fromRaw((int32_t)raw);
+}
+
+#endif // TIME_BASE
@@ -0,0 +1,219 @@
+#include "TuningLink.hpp"
+#include <IBusUart.hpp>
+
+const TuningLink::Param *TuningLink::params = nullptr;
+uint8_t TuningLink::paramCount = 0;
+ParamStore *TuningLink::store = nullptr;
+uint8_t *TuningLink::snapshot = nullptr;
+void (*TuningLink::onChange)(uint8_t id) = nullptr;
+
+uint8_t TuningLink::rxFrame[requestLength];
+uint8_t TuningLink::rxPosition = 0;
+uint8_t TuningLink::request[requestLength];
+volatile bool TuningLink::pending = false;
+volatile uint16_t TuningLink::dropped = 0;
+uint16_t TuningLink::badRequests = 0;
+bool TuningLink::committing = false;
+
+const uint8_t TuningLink::syncByte;
+const uint8_t TuningLink::requestLength;
+const uint8_t TuningLink::allParams;
+
+
+void TuningLink::begin(const Param *table, uint8_t count, ParamStore &paramStore, void *snapshotBuffer, void (*changeHandler)(uint8_t id)) {
+  params = table;
+  paramCount = count;
+  store = &paramStore;
+  snapshot = (uint8_t *)snapshotBuffer;
+  onChange = changeHandler;
+
+  memcpy(snapshot, store->getBlock(), store->getSize());
+  IBusUart::setSideChannel(syncByte, handleByte);
+}
+
+
+bool TuningLink::handleByte(uint8_t data) {
+  rxFrame[rxPosition++] = data;
+
+  // Gives the line back after one byte if the command is unknown, so a stray sync byte costs little
+  if (rxPosition == 2 && (data < GET || data > COMMIT)) {
+    rxPosition = 0;
+    dropped++;
+    return false;
+  }
+
+  if (rxPosition < requestLength) {
+    return true;
+  }
+
+  rxPosition = 0;
+  if (pending) {
+    dropped++;
+  } else {
+    memcpy(request, rxFrame, requestLength);
+    pending = true;
+  }
+
+  return false;
+}
+
+
+void TuningLink::poll() {
+  // Continues a commit, one byte per call
+  if (committing) {
+    ParamStore::SaveState state = store->pollSave();
+
+    if (state != ParamStore::SAVE_BUSY) {
+      committing = false;
+      int32_t saves = store->getSequence();
+      respond(COMMIT, allParams, state == ParamStore::SAVE_DONE ? OK : FAILED, &saves, 1);
+    }
+  }
+
+  if (!pending) {
+    return;
+  }
+
+  // The RX handler leaves the request alone until pending is cleared
+  uint8_t frame[requestLength];
+  memcpy(frame, request, requestLength);
+  pending = false;
+
+  uint16_t crc = frame[7] | (uint16_t)frame[8] << 8;
+  if (ParamStore::crc16(0xFFFF, frame + 1, 6) != crc) {
+    badRequests++;
+    return;
+  }
+
+  int32_t value = (uint32_t)frame[3] | (uint32_t)frame[4] << 8 | (uint32_t)frame[5] << 16 | (uint32_t)frame[6] << 24;
+  runRequest(frame[1], frame[2], value);
+}
+
+
+void TuningLink::runRequest(uint8_t command, uint8_t id, int32_t value) {
+  // Commands on the whole block
+  switch (command) {
+    case COUNT: {
+      int32_t count = paramCount;
+      respond(command, allParams, OK, &count, 1);
+      return;
+    }
+
+    case SNAPSHOT:
+      memcpy(snapshot, store->getBlock(), store->getSize());
+      respond(command, allParams, OK);
+      return;
+
+    case REVERT:
+      if (committing) {
+        respond(command, allParams, BUSY);
+        return;
+      }
+
+      memcpy(store->getBlock(), snapshot, store->getSize());
+      if (onChange != nullptr) {
+        onChange(allParams);
+      }
+      respond(command, allParams, OK);
+      return;
+
+    case COMMIT:
+      // Responds from poll() once the save is done
+      if (!committing) {
+        store->beginSave();
+        committing = true;
+      }
+      return;
+  }
+
+  // Commands on a single parameter
+  if (id >= paramCount) {
+    respond(command, id, BAD_ID);
+    return;
+  }
+
+  Param param;
+  readParam(id, param);
+  int32_t current = readValue(param);
+
+  switch (command) {
+    case GET:
+      respond(command, id, OK, &current, 1);
+      break;
+
+    case SET:
+      if (committing) {
+        respond(command, id, BUSY, &current, 1);
+      } else if (value < param.min || value > param.max) {
+        respond(command, id, OUT_OF_RANGE, &current, 1);
+      } else {
+        writeValue(param, value);
+        if (onChange != nullptr) {
+          onChange(id);
+        }
+
+        current = readValue(param);
+        respond(command, id, OK, &current, 1);
+      }
+      break;
+
+    case INFO: {
+      int32_t info[3] = {param.type, param.min, param.max};
+      respond(command, id, OK, info, 3);
+      break;
+    }
+
+    default:
+      respond(command, id, BAD_COMMAND);
+      break;
+  }
+}
+
+
+void TuningLink::readParam(uint8_t id, Param &param) {
+  memcpy_P(&param, &params[id], sizeof(Param));
+}
+
+
+int32_t TuningLink::readValue(const Param &param) {
+  switch (param.type) {
+    case INT:     return *(int *)param.address;
+    case UINT16:  return *(uint16_t *)param.address;
+    case UINT32:  return (int32_t)*(uint32_t *)param.address;
+    case INT32:   return *(int32_t *)param.address;
+    case FIXED16: return ((Fixed16 *)param.address)->getRaw();
+  }
+
+  return 0;
+}
+
+
+void TuningLink::writeValue(const Param &param, int32_t value) {
+  switch (param.type) {
+    case INT:     *(int *)param.address = value; break;
+    case UINT16:  *(uint16_t *)param.address = value; break;
+    case UINT32:  *(uint32_t *)param.address = value; break;
+    case INT32:   *(int32_t *)param.address = value; break;
+    case FIXED16: *(Fixed16 *)param.address = Fixed16::fromRaw(value); break;
+  }
+}
+
+
+void TuningLink::respond(uint8_t command, uint8_t id, Status status, const int32_t *values, uint8_t count) {
+  int32_t response[2 + 3] = {command, status};
+
+  for (uint8_t i = 0; i < count && i < 3; i++) {
+    response[2 + i] = values[i];
+  }
+
+  Telemetry::send(Telemetry::PARAM, id, response, 2 + count);
+}
+
+
+uint16_t TuningLink::getBadRequests() {
+  noInterrupts();
+  uint16_t count = dropped;
+  interrupts();
+
+  return count + badRequests;
+}
@@ -0,0 +1,167 @@
+#ifndef TUNING_LINK
+#define TUNING_LINK
+
+#include <Arduino.h>
+#include <ParamStore.hpp>
+#include <FixedPoint.hpp>
+#include <Telemetry.hpp>
+
+/*-----------------------------------------------------------------------------*/
+/** @file   TuningLink.hpp
+ * @brief   Header for TuningLink class (live parameter get/set sharing the iBus RX line)
+*//*---------------------------------------------------------------------------*/
+
+
+/**
+ * @brief Class used to read and change parameters while the sketch runs
+ * 
+ * @note Requests arrive on the iBus RX line in the gaps between iBus frames (See IBusUart::setSideChannel()).
+ * Every request is 9 bytes: sync (0xA5), command, parameter ID, little-endian int32 value, and a
+ * little-endian CRC-16/CCITT of the command, ID, and value. At 115200 baud it takes 0.8 ms, so it 
+ * fits between two iBus frames. The RX handler only stores the bytes, and poll() runs the request 
+ * from the loop. Responses are Telemetry PARAM records with the parameter ID as the record ID and 
+ * int32 values: command, status, then the command's values. A request that hits an iBus frame on 
+ * the line fails its CRC and is dropped without a response, so the host sends it again.
+ * 
+ * @note Parameters are described by a table in PROGMEM pointing into a ParamStore block. SNAPSHOT 
+ * keeps a copy of the block in RAM that REVERT goes back to, and COMMIT saves the block to EEPROM 
+ * a byte at a time from poll(), so the loop never waits for the EEPROM.
+ */
+class TuningLink {
+  public:
+    /**
+     * @brief Storage type of a parameter
+     */
+    enum ParamType : uint8_t {
+      INT = 0,   // int (16 bits on AVR)
+      UINT16,    // uint16_t
+      UINT32,    // uint32_t (Limited to the int32 range)
+      INT32,     // int32_t
+      FIXED16    // Fixed16, sent as its raw Q16.16 value
+    };
+
+    /**
+     * @brief Entry in the parameter table, the index is the parameter ID
+     */
+    struct Param {
+      void *address;  // Field in the ParamStore block
+      ParamType type; // Storage type of the field
+      int32_t min;    // Smallest value SET accepts (Raw for FIXED16)
+      int32_t max;    // Largest value SET accepts (Raw for FIXED16)
+    };
+
+    /**
+     * @brief Request commands
+     */
+    enum Command : uint8_t {
+      GET = 1,      // Responds with the value
+      SET,          // Sets the value in RAM and responds with it
+      INFO,         // Responds with the type, minimum, and maximum
+      COUNT,        // Responds with the number of parameters (ID ignored)
+      SNAPSHOT,     // Copies the block so REVERT can go back to it (ID ignored)
+      REVERT,       // Copies the snapshot back into the block (ID ignored)
+      COMMIT        // Saves the block to EEPROM, responds with the save count once done (ID ignored)
+    };
+
+    /**
+     * @brief Response status
+     */
+    enum Status : uint8_t {
+      OK = 0,       // Done
+      BAD_ID,       // No parameter with that ID
+      OUT_OF_RANGE, // SET value outside the parameter's range, nothing changed
+      BUSY,         // A commit is still writing, nothing changed
+      FAILED,       // The commit didn't read back correctly
+      BAD_COMMAND   // Unknown command
+    };
+
+    static const uint8_t syncByte = 0xA5;   // First byte of every request
+    static const uint8_t requestLength = 9; // Bytes in a request
+    static const uint8_t allParams = 0xFF;  // ID given to the change handler when the whole block changed
+
+  private:
+    static const Param *params;          // Parameter table in PROGMEM
+    static uint8_t paramCount;           // Number of parameters
+    static ParamStore *store;            // Store holding the block the parameters are in
+    static uint8_t *snapshot;            // Copy of the block kept by SNAPSHOT
+    static void (*onChange)(uint8_t id); // Called after SET or REVERT changes the block
+
+    static uint8_t rxFrame[requestLength];   // Request being received
+    static uint8_t rxPosition;               // Next byte of the request being received
+    static uint8_t request[requestLength];   // Last complete request
+    static volatile bool pending;            // Condition for if the last request hasn't been run
+    static volatile uint16_t dropped;        // Number of requests dropped in the RX handler
+    static uint16_t badRequests;             // Number of requests dropped for a bad CRC
+    static bool committing;                  // Condition for if a COMMIT is writing
+
+
+    /**
+     * @brief Reads a parameter's table entry from PROGMEM
+     */
+    static void readParam(uint8_t id, Param &param);
+
+
+    /**
+     * @brief Reads a parameter's value as an int32
+     */
+    static int32_t readValue(const Param &param);
+
+
+    /**
+     * @brief Writes an int32 to a parameter
+     */
+    static void writeValue(const Param &param, int32_t value);
+
+
+    /**
+     * @brief Runs a complete request
+     */
+    static void runRequest(uint8_t command, uint8_t id, int32_t value);
+
+
+    /**
+     * @brief Sends a PARAM response record
+     */
+    static void respond(uint8_t command, uint8_t id, Status status, const int32_t *values = nullptr, uint8_t count = 0);
+
+  public:
+    /**
+     * @brief Starts listening for requests on the iBus RX line
+     * 
+     * @note Call after ControlRC::begin(), and after the store has loaded. A snapshot is taken right away.
+     * 
+     * @param table Parameter table, stored with PROGMEM
+     * @param count Number of parameters in the table
+     * @param paramStore Store holding the block the parameters point into
+     * @param snapshotBuffer Buffer the size of the block, used by SNAPSHOT and REVERT
+     * @param changeHandler Called with the parameter ID (or allParams) after the block changes (nullptr for none)
+     */
+    static void begin(const Param *table, uint8_t count, ParamStore &paramStore, void *snapshotBuffer, void (*changeHandler)(uint8_t id) = nullptr);
+
+
+    /**
+     * @brief Runs the last request and continues a commit
+     * 
+     * @note Does at most one EEPROM byte write per call, and never waits for the EEPROM
+     */
+    static void poll();
+
+
+    /**
+     * @brief Gets the number of requests dropped for a bad CRC or for arriving before the last one ran
+     * 
+     * @return Number of dropped requests
+     */
+    static uint16_t getBadRequests();
+
+
+    /**
+     * @brief Stores a request byte (Called by IBusUart, possibly from the RX interrupt)
+     * 
+     * @param data Byte received
+     * @return Condition for if the request needs more bytes
+     */
+    static bool handleByte(uint8_t data);
+};
+
+#endif // TUNING_LINK
@@ -0,0 +1,155 @@
+#ifndef ARDUINO_SHIM
+#define ARDUINO_SHIM
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <stdio.h>
+#include <algorithm>
+#include <deque>
+#include <string>
+
+#include "avr/pgmspace.h"
+
+/*-----------------------------------------------------------------------------*/
+/** @file   Arduino.h
+ * @brief   Minimal host version of the Arduino core used by the native environment
+*//*---------------------------------------------------------------------------*/
+
+
+#ifndef F_CPU
+#define F_CPU 16000000UL // Clock of the Uno, used by code that computes timer settings
+#endif
+
+#define HIGH 0x1
+#define LOW  0x0
+
+#define INPUT        0x0
+#define OUTPUT       0x1
+#define INPUT_PULLUP 0x2
+
+#define DEC 10
+#define HEX 16
+#define BIN 2
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+using std::min;
+using std::max;
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+
+/* --------------------------- Timing ---------------------------- */
+
+/**
+ * @brief Gets the fake clock in milliseconds
+ */
+unsigned long millis();
+
+/**
+ * @brief Gets the fake clock in microseconds
+ */
+unsigned long micros();
+
+/**
+ * @brief Advances the fake clock by a number of milliseconds
+ */
+void delay(unsigned long ms);
+
+/**
+ * @brief Advances the fake clock by a number of microseconds
+ */
+void delayMicroseconds(unsigned int us);
+
+inline void noInterrupts() {}
+inline void interrupts() {}
+
+
+/* ---------------------------- Pins ----------------------------- */
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+
+
+/* ---------------------------- Math ----------------------------- */
+
+long map(long x, long inMin, long inMax, long outMin, long outMax);
+
+
+/* --------------------------- Serial ---------------------------- */
+
+#define SERIAL_RX_BUFFER_SIZE 64 // Receive buffer of the AVR core on the Uno (The host queue itself is unbounded)
+
+/**
+ * @brief Host version of HardwareSerial
+ * 
+ * @note Received bytes are queued with inject(), and everything written is kept in a capture buffer
+ */
+class HardwareSerial {
+  private:
+    std::deque<uint8_t> rxQueue; // Bytes waiting to be read
+    std::string txCapture;       // Everything written since the last clearOutput()
+    bool echo = false;           // Condition for if written bytes are also sent to stdout
+
+    size_t printNumber(unsigned long value, int base, bool negative);
+
+  public:
+    void begin(unsigned long baudrate);
+    void end();
+
+    int available();
+    int peek();
+    int read();
+    int availableForWrite();
+    void flush();
+
+    size_t write(uint8_t data);
+    size_t write(const uint8_t *buffer, size_t size);
+
+    size_t print(const char *str);
+    size_t print(const std::string &str);
+    size_t print(char c);
+    size_t print(int value, int base = DEC);
+    size_t print(unsigned int value, int base = DEC);
+    size_t print(long value, int base = DEC);
+    size_t print(unsigned long value, int base = DEC);
+    size_t print(double value, int digits = 2);
+
+    template <class T>
+    size_t println(T value) { return print(value) + println(); }
+    size_t println(double value, int digits) { return print(value, digits) + println(); }
+    size_t println();
+
+    explicit operator bool() { return true; }
+
+
+    /* ------------------- Host only methods --------------------- */
+
+    /**
+     * @brief Queues bytes as if they were received on RX
+     */
+    void inject(const uint8_t *buffer, size_t size);
+
+    /**
+     * @brief Gets everything written since the last clearOutput()
+     */
+    const std::string& getOutput();
+
+    /**
+     * @brief Clears the capture buffer
+     */
+    void clearOutput();
+
+    /**
+     * @brief Sets whether written bytes are also sent to stdout
+     */
+    void setEcho(bool enabled);
+};
+
+extern HardwareSerial Serial;
+
+#endif // ARDUINO_SHIM
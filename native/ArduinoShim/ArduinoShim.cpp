@@ -0,0 +1,224 @@
+#include "Arduino.h"
+#include "FakeClock.hpp"
+
+HardwareSerial Serial;
+
+
+/* -------------------------- Fake Clock ------------------------- */
+
+namespace {
+  uint32_t clockMicros = 0;      // Current fake time in microseconds
+  void (*tickHook)() = nullptr;  // Called every time the clock moves
+  uint8_t pinStates[64];         // Last value written to each pin
+}
+
+
+void FakeClock::setMicros(uint32_t now) {
+  clockMicros = now;
+  if (tickHook) { tickHook(); }
+}
+
+
+void FakeClock::advanceMicros(uint32_t change) {
+  clockMicros += change;
+  if (tickHook) { tickHook(); }
+}
+
+
+uint32_t FakeClock::now() {
+  return clockMicros;
+}
+
+
+void FakeClock::setTickHook(void (*hook)()) {
+  tickHook = hook;
+}
+
+
+unsigned long millis() {
+  return clockMicros / 1000;
+}
+
+
+unsigned long micros() {
+  return clockMicros;
+}
+
+
+void delay(unsigned long ms) {
+  FakeClock::advanceMicros(ms * 1000);
+}
+
+
+void delayMicroseconds(unsigned int us) {
+  FakeClock::advanceMicros(us);
+}
+
+
+/* ---------------------------- Pins ----------------------------- */
+
+void pinMode(uint8_t, uint8_t) {}
+
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+  if (pin < sizeof(pinStates)) {
+    pinStates[pin] = value ? HIGH : LOW;
+  }
+}
+
+
+int digitalRead(uint8_t pin) {
+  return pin < sizeof(pinStates) ? pinStates[pin] : LOW;
+}
+
+
+/* ---------------------------- Math ----------------------------- */
+
+long map(long x, long inMin, long inMax, long outMin, long outMax) {
+  return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+
+
+/* --------------------------- Serial ---------------------------- */
+
+void HardwareSerial::begin(unsigned long) {}
+
+
+void HardwareSerial::end() {}
+
+
+int HardwareSerial::available() {
+  return rxQueue.size();
+}
+
+
+int HardwareSerial::peek() {
+  return rxQueue.empty() ? -1 : rxQueue.front();
+}
+
+
+int HardwareSerial::read() {
+  if (rxQueue.empty()) {
+    return -1;
+  }
+
+  uint8_t data = rxQueue.front();
+  rxQueue.pop_front();
+  return data;
+}
+
+
+int HardwareSerial::availableForWrite() {
+  return 63; // Size of the AVR transmit buffer, which is never full on the host
+}
+
+
+void HardwareSerial::flush() {
+  if (echo) { fflush(stdout); }
+}
+
+
+size_t HardwareSerial::write(uint8_t data) {
+  txCapture.push_back((char)data);
+  if (echo) { putchar(data); }
+  return 1;
+}
+
+
+size_t HardwareSerial::write(const uint8_t *buffer, size_t size) {
+  for (size_t i = 0; i < size; i++) {
+    write(buffer[i]);
+  }
+  return size;
+}
+
+
+size_t HardwareSerial::printNumber(unsigned long value, int base, bool negative) {
+  char buffer[8 * sizeof(long) + 2];
+  char *str = &buffer[sizeof(buffer) - 1];
+  *str = '\0';
+
+  if (base < 2) { base = 10; }
+  do {
+    char digit = value % base;
+    value /= base;
+    *--str = digit < 10 ? digit + '0' : digit + 'A' - 10;
+  } while (value);
+
+  if (negative) { *--str = '-'; }
+  return print(str);
+}
+
+
+size_t HardwareSerial::print(const char *str) {
+  return write((const uint8_t *)str, strlen(str));
+}
+
+
+size_t HardwareSerial::print(const std::string &str) {
+  return write((const uint8_t *)str.data(), str.size());
+}
+
+
+size_t HardwareSerial::print(char c) {
+  return write((uint8_t)c);
+}
+
+
+size_t HardwareSerial::print(int value, int base) {
+  return print((long)value, base);
+}
+
+
+size_t HardwareSerial::print(unsigned int value, int base) {
+  return print((unsigned long)value, base);
+}
+
+
+size_t HardwareSerial::print(long value, int base) {
+  if (base == 10 && value < 0) {
+    return printNumber(-(unsigned long)value, base, true);
+  }
+  return printNumber(value, base, false);
+}
+
+
+size_t HardwareSerial::print(unsigned long value, int base) {
+  return printNumber(value, base, false);
+}
+
+
+size_t HardwareSerial::print(double value, int digits) {
+  char buffer[48];
+
+  if (isnan(value)) { return print("nan"); }
+  if (isinf(value)) { return print("inf"); }
+
+  snprintf(buffer, sizeof(buffer), "%.*f", digits, value);
+  return print(buffer);
+}
+
+
+size_t HardwareSerial::println() {
+  return print("\r\n");
+}
+
+
+void HardwareSerial::inject(const uint8_t *buffer, size_t size) {
+  rxQueue.insert(rxQueue.end(), buffer, buffer + size);
+}
+
+
+const std::string& HardwareSerial::getOutput() {
+  return txCapture;
+}
+
+
+void HardwareSerial::clearOutput() {
+  txCapture.clear();
+}
+
+
+void HardwareSerial::setEcho(bool enabled) {
+  echo = enabled;
+}
@@ -0,0 +1,65 @@
+#include "EEPROM.h"
+
+EEPROMClass EEPROM;
+
+namespace {
+  uint8_t cells[EEPROMClass::size] = {};      // Stored bytes
+  uint32_t writeCounts[EEPROMClass::size] = {}; // Writes to each byte
+  bool erased = false;                        // Condition for if the cells have been set to 0xFF
+  uint32_t totalWrites = 0;                   // Writes to every byte
+
+  /**
+   * @brief Erases the cells the first time they are used, like a new chip
+   */
+  inline void checkErased() {
+    if (!erased) {
+      EEPROM.erase();
+    }
+  }
+}
+
+
+const uint16_t EEPROMClass::size;
+
+
+uint8_t EEPROMClass::read(int idx) {
+  checkErased();
+  return idx >= 0 && idx < size ? cells[idx] : 0xFF;
+}
+
+
+void EEPROMClass::write(int idx, uint8_t value) {
+  checkErased();
+  if (idx >= 0 && idx < size) {
+    cells[idx] = value;
+    writeCounts[idx]++;
+    totalWrites++;
+  }
+}
+
+
+void EEPROMClass::update(int idx, uint8_t value) {
+  if (read(idx) != value) {
+    write(idx, value);
+  }
+}
+
+
+void EEPROMClass::erase() {
+  for (uint16_t i = 0; i < size; i++) {
+    cells[i] = 0xFF;
+    writeCounts[i] = 0;
+  }
+  totalWrites = 0;
+  erased = true;
+}
+
+
+uint32_t EEPROMClass::getWriteCount(int idx) {
+  return idx >= 0 && idx < size ? writeCounts[idx] : 0;
+}
+
+
+uint32_t EEPROMClass::getTotalWrites() {
+  return totalWrites;
+}
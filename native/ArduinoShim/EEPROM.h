@@ -0,0 +1,61 @@
+#ifndef ARDUINO_SHIM_EEPROM
+#define ARDUINO_SHIM_EEPROM
+
+#include <stdint.h>
+
+/*-----------------------------------------------------------------------------*/
+/** @file   EEPROM.h
+ * @brief   Host version of the Arduino EEPROM library (1 KB like the Uno, kept in memory)
+*//*---------------------------------------------------------------------------*/
+
+
+/**
+ * @brief Host version of EEPROMClass
+ * 
+ * @note Starts erased (Every byte 0xFF) and counts the writes to each byte, so wear can be checked
+ */
+class EEPROMClass {
+  public:
+    static const uint16_t size = 1024; // Bytes of EEPROM on the ATmega328P
+
+    uint8_t read(int idx);
+    void write(int idx, uint8_t value);
+    void update(int idx, uint8_t value);
+    uint16_t length() { return size; }
+
+    template <class T>
+    T& get(int idx, T &value) {
+      uint8_t *bytes = (uint8_t *)&value;
+      for (uint16_t i = 0; i < sizeof(T); i++) { bytes[i] = read(idx + i); }
+      return value;
+    }
+
+    template <class T>
+    const T& put(int idx, const T &value) {
+      const uint8_t *bytes = (const uint8_t *)&value;
+      for (uint16_t i = 0; i < sizeof(T); i++) { update(idx + i, bytes[i]); }
+      return value;
+    }
+
+
+    /* ------------------- Host only methods --------------------- */
+
+    /**
+     * @brief Sets every byte back to 0xFF and clears the write counts
+     */
+    void erase();
+
+    /**
+     * @brief Gets the number of times a byte has been written (Updates that matched aren't counted)
+     */
+    uint32_t getWriteCount(int idx);
+
+    /**
+     * @brief Gets the number of writes to every byte since the last erase()
+     */
+    uint32_t getTotalWrites();
+};
+
+extern EEPROMClass EEPROM;
+
+#endif // ARDUINO_SHIM_EEPROM
@@ -0,0 +1,34 @@
+#ifndef FAKE_CLOCK
+#define FAKE_CLOCK
+
+#include <stdint.h>
+
+/*-----------------------------------------------------------------------------*/
+/** @file   FakeClock.hpp
+ * @brief   Controllable clock behind millis() and micros() in the native environment
+*//*---------------------------------------------------------------------------*/
+
+
+namespace FakeClock {
+  /**
+   * @brief Sets the clock to an absolute time in microseconds (Wraps like micros())
+   */
+  void setMicros(uint32_t now);
+
+  /**
+   * @brief Moves the clock forward by a number of microseconds
+   */
+  void advanceMicros(uint32_t change);
+
+  /**
+   * @brief Gets the clock in microseconds
+   */
+  uint32_t now();
+
+  /**
+   * @brief Sets a function that is called every time the clock moves (Used by fake peripherals)
+   */
+  void setTickHook(void (*hook)());
+}
+
+#endif // FAKE_CLOCK
@@ -0,0 +1,73 @@
+#include "FakeIBus.hpp"
+#include "FakeClock.hpp"
+
+const uint8_t FakeIBus::signal;
+
+
+FakeIBus::FakeIBus() {
+  for (uint8_t i = 0; i < numChannels; i++) {
+    channels[i] = 1000;
+  }
+}
+
+
+void FakeIBus::setScript(const Step *steps, size_t length) {
+  script = steps;
+  scriptLength = length;
+  nextStep = 0;
+}
+
+
+void FakeIBus::setChannel(uint8_t channel, uint16_t value) {
+  if (channel < numChannels) {
+    channels[channel] = value;
+  }
+}
+
+
+void FakeIBus::setSending(bool enabled) {
+  sending = enabled;
+}
+
+
+void FakeIBus::update() {
+  uint32_t now = FakeClock::now();
+
+  while (nextStep < scriptLength && (int32_t)(now / 1000 - script[nextStep].timeMillis) >= 0) {
+    if (script[nextStep].channel == signal) {
+      setSending(script[nextStep].value != 0);
+    } else {
+      setChannel(script[nextStep].channel, script[nextStep].value);
+    }
+    nextStep++;
+  }
+
+  while ((int32_t)(now - nextFrame) >= 0) {
+    if (sending) {
+      uint8_t frame[32];
+      encodeFrame(frame);
+      Serial.inject(frame, sizeof(frame));
+    }
+    nextFrame += framePeriod;
+  }
+}
+
+
+void FakeIBus::encodeFrame(uint8_t frame[32]) {
+  uint16_t sum = 0;
+
+  frame[0] = 0x20;
+  frame[1] = 0x40;
+  for (uint8_t i = 0; i < numChannels; i++) {
+    frame[2 + 2 * i] = channels[i] & 0xFF;
+    frame[3 + 2 * i] = channels[i] >> 8;
+  }
+
+  for (uint8_t i = 0; i < 30; i++) {
+    sum += frame[i];
+  }
+  sum = 0xFFFF - sum;
+
+  frame[30] = sum & 0xFF;
+  frame[31] = sum >> 8;
+}
@@ -0,0 +1,85 @@
+#ifndef FAKE_IBUS
+#define FAKE_IBUS
+
+#include <Arduino.h>
+
+/*-----------------------------------------------------------------------------*/
+/** @file   FakeIBus.hpp
+ * @brief   Scripted iBus receiver for the native environment
+*//*---------------------------------------------------------------------------*/
+
+
+/**
+ * @brief Class used to play back scripted channel values as iBus frames on the fake Serial port
+ * 
+ * @note Frames are encoded exactly like a FlySky receiver sends them, so the real IBusDecoder 
+ * and ControlRC code paths run on the host
+ */
+class FakeIBus {
+  public:
+    static const uint8_t numChannels = 14;         // Channels in an iBus frame
+    static const uint32_t framePeriod = 7000;      // Time between frames in microseconds
+    static const uint8_t signal = 0xFF;            // Step channel that stops (value 0) or restarts (value 1) the frames
+
+    /**
+     * @brief Scripted change of a channel value
+     */
+    struct Step {
+      uint32_t timeMillis; // Time the change happens in milliseconds
+      uint8_t channel;     // Channel to change (Or signal for a scripted dropout)
+      uint16_t value;      // New raw value of the channel
+    };
+
+  private:
+    uint16_t channels[numChannels]; // Current value of each channel
+    const Step *script = nullptr;   // Scripted changes, sorted by time
+    size_t scriptLength = 0;        // Number of scripted changes
+    size_t nextStep = 0;            // Index of the next scripted change
+    uint32_t nextFrame = 0;         // Time of the next frame in microseconds
+    bool sending = true;            // Condition for if frames are sent (False simulates signal loss)
+
+  public:
+    /**
+     * @brief Defines a new FakeIBus with every channel at the minimum value
+     */
+    FakeIBus();
+
+
+    /**
+     * @brief Sets the script to play back
+     * 
+     * @param steps Scripted changes, sorted by time
+     * @param length Number of scripted changes
+     */
+    void setScript(const Step *steps, size_t length);
+
+
+    /**
+     * @brief Sets a channel value directly
+     */
+    void setChannel(uint8_t channel, uint16_t value);
+
+
+    /**
+     * @brief Starts or stops sending frames
+     */
+    void setSending(bool enabled);
+
+
+    /**
+     * @brief Applies due script steps and sends every frame that is due on the fake Serial port
+     * 
+     * @note Call whenever the fake clock moves (FakeClock::setTickHook)
+     */
+    void update();
+
+
+    /**
+     * @brief Encodes the current channel values into a 32 byte iBus frame
+     * 
+     * @param frame Buffer of 32 bytes to fill
+     */
+    void encodeFrame(uint8_t frame[32]);
+};
+
+#endif // FAKE_IBUS
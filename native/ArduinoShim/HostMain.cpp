@@ -0,0 +1,64 @@
+#if !defined(NATIVE_NO_HOST_MAIN) && !defined(PIO_UNIT_TESTING)
+
+#include <Arduino.h>
+#include "FakeClock.hpp"
+#include "FakeIBus.hpp"
+
+/*-----------------------------------------------------------------------------*/
+/** @file   HostMain.cpp
+ * @brief   Runs the sketch on the host against the fake clock and a scripted receiver
+*//*---------------------------------------------------------------------------*/
+
+
+#ifndef NATIVE_RUN_MILLIS
+#define NATIVE_RUN_MILLIS 10000 // Fake time to run the sketch for
+#endif
+
+#ifndef NATIVE_LOOP_MICROS
+#define NATIVE_LOOP_MICROS 50   // Fake time each pass through loop() takes
+#endif
+
+
+void setup();
+void loop();
+
+namespace {
+  FakeIBus receiver;
+
+  // Sticks centered and throttle down, then enables the motor and steps the speed switch
+  const FakeIBus::Step script[] = {
+    {0,    0, 1500}, // RIGHT_X centered
+    {0,    1, 1500}, // RIGHT_Y centered
+    {0,    3, 1500}, // LEFT_X centered
+    {1000, 5, 2000}, // SWD on, enables the motor
+    {2000, 7, 2000}, // SWC high
+    {5000, 7, 1500}, // SWC middle
+    {6000, FakeIBus::signal, 0}, // Receiver drops out, the motor ramps down in failsafe
+    {6500, FakeIBus::signal, 1}, // Signal back, stays disarmed because SWD is still on
+    {8000, 5, 1000}, // SWD off, zeroed so it arms again
+    {8000, 7, 1000}  // SWC low
+  };
+
+  void onTick() {
+    receiver.update();
+  }
+}
+
+
+int main() {
+  Serial.setEcho(true);
+  receiver.setScript(script, sizeof(script) / sizeof(script[0]));
+  FakeClock::setTickHook(onTick);
+
+  setup();
+  while (millis() < NATIVE_RUN_MILLIS) {
+    loop();
+    FakeClock::advanceMicros(NATIVE_LOOP_MICROS);
+    Serial.clearOutput();
+  }
+
+  Serial.flush();
+  return 0;
+}
+
+#endif // NATIVE_NO_HOST_MAIN, PIO_UNIT_TESTING
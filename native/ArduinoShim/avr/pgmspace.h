@@ -0,0 +1,21 @@
+#ifndef ARDUINO_SHIM_PGMSPACE
+#define ARDUINO_SHIM_PGMSPACE
+
+#include <stdint.h>
+#include <string.h>
+
+/*-----------------------------------------------------------------------------*/
+/** @file   avr/pgmspace.h
+ * @brief   Host version of the AVR program memory helpers (Flash is ordinary memory here)
+*//*---------------------------------------------------------------------------*/
+
+
+#define PROGMEM
+
+#define pgm_read_byte(addr)  (*(const uint8_t *)(addr))
+#define pgm_read_word(addr)  (*(const uint16_t *)(addr))
+#define pgm_read_dword(addr) (*(const uint32_t *)(addr))
+
+#define memcpy_P(dest, src, n) memcpy((dest), (src), (n))
+
+#endif // ARDUINO_SHIM_PGMSPACE
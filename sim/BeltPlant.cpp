@@ -0,0 +1,73 @@
+#include "BeltPlant.hpp"
+
+/* --------------------- BeltPlant Constructors -------------------- */
+
+const uint16_t BeltPlant::maxDelaySteps;
+
+
+BeltPlant::BeltPlant(const Config &plantConfig) {
+  config = plantConfig;
+
+  uint32_t steps = (uint32_t)(config.deadTime / config.stepSeconds + 0.5);
+  delaySteps = steps < maxDelaySteps ? steps : maxDelaySteps;
+
+  reset();
+}
+
+/* ----------------------------------------------------------------- */
+
+
+
+/* ----------------------- BeltPlant Methods ----------------------- */
+
+void BeltPlant::reset() {
+  for (uint16_t i = 0; i < maxDelaySteps; i++) {
+    delayLine[i] = 0;
+  }
+
+  delayIndex = 0;
+  throttle = 0;
+  speed = 0;
+  load = 0;
+}
+
+
+void BeltPlant::setLoad(double speedLoss) {
+  load = speedLoss;
+}
+
+
+double BeltPlant::update(double command) {
+  // Saturation of the ESC input
+  command = command < 0 ? 0 : command > 100 ? 100 : command;
+
+  // Dead time, the command comes back out delaySteps steps later
+  double delayed = command;
+  if (delaySteps > 0) {
+    delayed = delayLine[delayIndex];
+    delayLine[delayIndex] = command;
+    delayIndex = (delayIndex + 1) % delaySteps;
+  }
+
+  // ESC lag and deadband
+  throttle += (delayed - throttle) * config.stepSeconds / config.escTau;
+  double drive = throttle > config.escDeadband
+    ? (throttle - config.escDeadband) * 100 / (100 - config.escDeadband)
+    : 0;
+
+  // Motor and belt lag, the load can slow the belt but never drive it backwards
+  double target = drive * config.topSpeed / 100 - load;
+  speed += (target - speed) * config.stepSeconds / config.motorTau;
+  if (speed < 0) {
+    speed = 0;
+  }
+
+  return speed;
+}
+
+
+double BeltPlant::getSpeed() const {
+  return speed;
+}
+
+/* ----------------------------------------------------------------- */
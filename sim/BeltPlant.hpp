@@ -0,0 +1,85 @@
+#ifndef BELT_PLANT
+#define BELT_PLANT
+
+#include <stdint.h>
+
+/*-----------------------------------------------------------------------------*/
+/** @file   BeltPlant.hpp
+ * @brief   Header for BeltPlant class (simulated ESC, motor and belt for the native_sim environment)
+*//*---------------------------------------------------------------------------*/
+
+
+/**
+ * @brief Simulated ESC, motor and belt driven by a throttle command
+ * 
+ * @note The command is delayed by a dead time, lagged by the ESC, passed through the ESC deadband,
+ * and lagged again by the motor and belt. Speed is a percentage of the top speed at full throttle.
+ */
+class BeltPlant {
+  public:
+    static const uint16_t maxDelaySteps = 256; // Longest dead time in steps
+
+    /**
+     * @brief Physical constants of the plant
+     */
+    struct Config {
+      double stepSeconds = 0.001; // Time per update() call
+      double deadTime = 0.02;     // Delay from command to the ESC reacting in seconds
+      double escTau = 0.03;       // Time constant of the ESC in seconds
+      double escDeadband = 5;     // Throttle below which the motor doesn't turn in percent
+      double motorTau = 0.35;     // Time constant of the motor and belt in seconds
+      double topSpeed = 100;      // Belt speed at full throttle and no load in percent
+    };
+
+  private:
+    Config config;
+
+    double delayLine[maxDelaySteps]; // Commands waiting out the dead time
+    uint16_t delaySteps = 0;         // Number of steps in the dead time
+    uint16_t delayIndex = 0;         // Oldest command in the delay line
+
+    double throttle = 0; // ESC output in percent
+    double speed = 0;    // Belt speed in percent
+    double load = 0;     // Speed lost to the load at steady state in percent
+
+  public:
+    /**
+     * @brief Defines a plant at rest
+     * 
+     * @param plantConfig Physical constants of the plant
+     */
+    BeltPlant(const Config &plantConfig);
+
+
+    /**
+     * @brief Puts the plant back at rest with no load
+     */
+    void reset();
+
+
+    /**
+     * @brief Sets the load on the belt
+     * 
+     * @param speedLoss Speed lost to the load at steady state in percent
+     */
+    void setLoad(double speedLoss);
+
+
+    /**
+     * @brief Advances the plant by one step
+     * 
+     * @param command Throttle command in percent (Saturated to [0, 100])
+     * @return Belt speed in percent after the step
+     */
+    double update(double command);
+
+
+    /**
+     * @brief Gets the belt speed
+     * 
+     * @return Belt speed in percent
+     */
+    double getSpeed() const;
+};
+
+#endif // BELT_PLANT
@@ -0,0 +1,305 @@
+// External Libraries 
+#include <Arduino.h>
+#include <FakeClock.hpp>
+#include <chrono>
+
+// Custom Libraries
+#include <PidCommand.hpp>
+#include <IntSlewRateLimiter.hpp>
+
+// Simulation
+#include "BeltPlant.hpp"
+#include "StepMetrics.hpp"
+
+
+/** 
+ * Runs PidCommand and IntSlewRateLimiter against a simulated ESC, motor and belt
+ * 
+ * Every scenario is a step in the belt speed setpoint from rest. The plant moves
+ * 1 ms per step on the fake clock, so micros() inside the libraries reads the
+ * simulated time. Each run starts shortly before micros() wraps, so every controller
+ * crosses the rollover during its step response. Build and run with `pio run -e native_sim -t exec`. A table of
+ * rise time, overshoot, settling time, IAE, output travel (total change of the throttle
+ * command, a measure of chatter) and host nanoseconds per controller step is printed.
+ * A second table sweeps the setpoint through a gain schedule and checks that the gains
+ * follow the interpolated table without jumps. The program exits with 1 if a run that
+ * must settle doesn't, or if the sweep fails its checks.
+**/ 
+
+
+const uint32_t plantStepMicros = 1000;     // Time per plant step
+const uint32_t controlPeriodMicros = 20000; // Time between controller steps (controlPeriod of the motor task in main.cpp)
+const uint32_t startMicros = 0xFFFFFFFFUL - 500000; // Fake clock at the start of a run, 0.5 s before the wrap
+
+/**
+ * @brief One simulated run
+ */
+struct Scenario {
+  const char *name;
+  double setpoint;        // Belt speed setpoint in percent
+  double seconds;         // Length of the run
+  double kP, kI, kD;      // PID gains (Throttle percent per speed percent)
+  PidCommandBase::AntiWindup antiWindup;
+  double filterHz;        // Derivative filter cutoff (0 for none)
+  bool derivativeOnMeasurement;
+  uint32_t slewRate;      // ESC units per second for IntSlewRateLimiter (0 for no limiter)
+  double loadTime;        // Time the load disturbance starts (0 for none)
+  double load;            // Speed lost to the load in percent
+  double noise;           // Peak measurement noise in percent
+  bool mustSettle;        // Condition for if not settling fails the run (False for baselines kept for comparison)
+};
+
+const Scenario scenarios[] = {
+  // name                 set  time  kP   kI   kD    anti-windup                   filter DoM    slew load@ load noise must settle
+  {"step 50",             50,  6,    1.5, 4.0, 0,    PidCommandBase::CLAMP,            0,  false, 0,   0,   0,   0,    true},
+  {"step 50 slew",        50,  6,    1.5, 4.0, 0,    PidCommandBase::CLAMP,            0,  false, 120, 0,   0,   0,    true},
+  {"step 90 reset",       90,  6,    1.5, 4.0, 0,    PidCommandBase::RESET,            0,  false, 0,   0,   0,   0,    false},
+  {"step 90 clamp",       90,  6,    1.5, 4.0, 0,    PidCommandBase::CLAMP,            0,  false, 0,   0,   0,   0,    true},
+  {"step 90 backcalc",    90,  6,    1.5, 4.0, 0,    PidCommandBase::BACK_CALCULATION, 0,  false, 0,   0,   0,   0,    true},
+  {"load 20 at 3 s",      50,  8,    1.5, 4.0, 0,    PidCommandBase::CLAMP,            0,  false, 0,   3,   20,  0,    true},
+  {"noisy PID",           50,  6,    1.5, 4.0, 0.05, PidCommandBase::CLAMP,            0,  false, 0,   0,   0,   1,    true},
+  {"noisy PID filtered",  50,  6,    1.5, 4.0, 0.05, PidCommandBase::CLAMP,            10, true,  0,   0,   0,   1,    true},
+};
+
+const uint8_t numScenarios = sizeof(scenarios) / sizeof(scenarios[0]);
+
+// Gain schedule keyed on the setpoint, the feedforward is about the throttle that holds each speed
+const GainPoint sweepSchedule[] PROGMEM = {
+  //         key  kP   kI   kD   feedforward
+  GAIN_POINT(0,   2.0, 5.0, 0,   5),
+  GAIN_POINT(50,  1.5, 4.0, 0,   52),
+  GAIN_POINT(100, 1.0, 3.0, 0,   100),
+};
+
+const uint8_t sweepRows = sizeof(sweepSchedule) / sizeof(sweepSchedule[0]);
+const double sweepStart = 10;         // Setpoint at the start of the sweep in percent
+const double sweepEnd = 90;           // Setpoint at the end of the sweep in percent
+const double sweepHold = 2;           // Time held at each end of the sweep in seconds
+const double sweepSeconds = 8;        // Time to ramp between the ends in seconds
+const double sweepGainError = 0.002;  // Largest allowed difference from the interpolated table (Fixed16 fraction times the widest column)
+const double sweepTrackError = 5;     // Largest allowed speed error during the ramp in percent
+
+
+/**
+ * @brief Repeatable measurement noise in [-1, 1]
+ */
+double noiseSample(uint32_t &state) {
+  state = state * 1664525UL + 1013904223UL;
+  return ((double)(state >> 8) / (double)(1UL << 24)) * 2 - 1;
+}
+
+
+/**
+ * @brief Runs a scenario with one PID backend and prints a row of results
+ * 
+ * @tparam T Numeric type of the PID command
+ * @param scenario Scenario to run
+ * @param backend Name of the backend for the table
+ * @return Condition for if the run settled or wasn't required to
+ */
+template <class T>
+bool runScenario(const Scenario &scenario, const char *backend) {
+  BeltPlant::Config config;
+  BeltPlant plant(config);
+  StepMetrics metrics;
+  uint32_t noiseState = 1;
+
+  FakeClock::setMicros(startMicros);
+
+  T input = 0, output = 0, setpoint = T(scenario.setpoint);
+  T range[2] = {T(0), T(100)};
+  BasicPidCommand<T> pid(&input, &output, &setpoint, range, nullptr, T(scenario.kP), T(scenario.kI), T(scenario.kD));
+  pid.setIntegrationLimit(T(10));
+  pid.setAntiWindup(scenario.antiWindup, T(1 / scenario.kP));
+  pid.setDerivativeOnMeasurement(scenario.derivativeOnMeasurement);
+  pid.setDerivativeFilter(T(scenario.filterHz));
+  pid.reset(TimeBase::tick());
+
+  IntSlewRateLimiter limiter(scenario.slewRate);
+  double command = 0;
+  double travel = 0;
+
+  uint32_t steps = 0;
+  int64_t controlNanos = 0;
+  uint32_t runMicros = (uint32_t)(scenario.seconds * 1e6);
+
+  metrics.begin(0, scenario.setpoint);
+
+  for (uint32_t t = plantStepMicros; t <= runMicros; t += plantStepMicros) {
+    FakeClock::advanceMicros(plantStepMicros);
+
+    if (scenario.loadTime > 0 && t == (uint32_t)(scenario.loadTime * 1e6)) {
+      plant.setLoad(scenario.load);
+    }
+
+    // Controller at its own rate, timed on the host clock
+    if (t % controlPeriodMicros == 0) {
+      input = T(plant.getSpeed() + scenario.noise * noiseSample(noiseState));
+
+      std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+      TimeBase::tick();
+      pid.calculate(TimeBase::now());
+      int escTarget = (int)(static_cast<double>(output) * 1.8 + 0.5); // Percent to the 0 to 180 range esc.write() takes
+      int escValue = scenario.slewRate ? limiter.calculate(escTarget, TimeBase::now()) : escTarget;
+      controlNanos += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin).count();
+
+      travel += escValue / 1.8 > command ? escValue / 1.8 - command : command - escValue / 1.8;
+      command = escValue / 1.8;
+      steps++;
+    }
+
+    metrics.add(t * 1e-6, plant.update(command));
+  }
+
+  bool settled = metrics.getSettlingTime() >= 0;
+  printf("%-20s %-8s %8.3f %10.1f %9.3f %8.2f %8.1f %8.0f%s\n",
+    scenario.name, backend,
+    metrics.getRiseTime(), metrics.getOvershoot(), metrics.getSettlingTime(), metrics.getIAE(), travel,
+    steps ? (double)controlNanos / steps : 0.0,
+    settled ? "" : scenario.mustSettle ? "  NOT SETTLED" : "  not settled (baseline)");
+
+  return settled || !scenario.mustSettle;
+}
+
+
+/**
+ * @brief Linearly interpolates one column of the sweep schedule in double precision
+ * 
+ * @param key Setpoint to look up
+ * @param column Offset of the column in GainPoint
+ * @return Interpolated value, clamped to the first and last rows
+ */
+double interpolateSweep(double key, int32_t GainPoint::*column) {
+  if (key <= sweepSchedule[0].key / 65536.0) {
+    return sweepSchedule[0].*column / 65536.0;
+  }
+
+  for (uint8_t i = 1; i < sweepRows; i++) {
+    double lowKey = sweepSchedule[i - 1].key / 65536.0, highKey = sweepSchedule[i].key / 65536.0;
+    if (key <= highKey) {
+      double low = sweepSchedule[i - 1].*column / 65536.0, high = sweepSchedule[i].*column / 65536.0;
+      return low + (high - low) * (key - lowKey) / (highKey - lowKey);
+    }
+  }
+
+  return sweepSchedule[sweepRows - 1].*column / 65536.0;
+}
+
+
+/**
+ * @brief Ramps the setpoint through the gain schedule in closed loop and prints a row of results
+ * 
+ * @note Checks every controller step that the gains in use match the interpolated table, and that no gain
+ * moves more between steps than the steepest table slope allows for the change in setpoint
+ * 
+ * @tparam T Numeric type of the PID command
+ * @param backend Name of the backend for the table
+ * @return Condition for if the gains and tracking stayed inside their limits
+ */
+template <class T>
+bool runScheduleSweep(const char *backend) {
+  BeltPlant::Config config;
+  BeltPlant plant(config);
+  GainSchedule schedule(sweepSchedule, sweepRows);
+
+  FakeClock::setMicros(startMicros);
+
+  T input = T(sweepStart), output = 0, setpoint = T(sweepStart);
+  T range[2] = {T(0), T(100)};
+  BasicPidCommand<T> pid(&input, &output, &setpoint, range, nullptr, T(1)); // Gains come from the schedule
+  pid.setIntegrationLimit(T(10));
+  pid.setGainSchedule(&schedule);
+  pid.reset(TimeBase::tick());
+
+  int32_t GainPoint::*const columns[4] = {&GainPoint::kP, &GainPoint::kI, &GainPoint::kD, &GainPoint::feedforward};
+
+  // Steepest change of any gain per unit of setpoint
+  double maxSlope = 0;
+  for (uint8_t i = 1; i < sweepRows; i++) {
+    for (uint8_t c = 0; c < 4; c++) {
+      double slope = fabs((double)(sweepSchedule[i].*columns[c] - sweepSchedule[i - 1].*columns[c]) / (sweepSchedule[i].key - sweepSchedule[i - 1].key));
+      maxSlope = slope > maxSlope ? slope : maxSlope;
+    }
+  }
+
+  double lastGains[4] = {0, 0, 0, 0};
+  double lastKey = 0;
+  bool first = true;
+  double maxStep = 0, maxError = 0, maxTrack = 0;
+  bool smooth = true;
+  double command = 0;
+
+  // Starts the plant at the first setpoint, so only the ramp is measured
+  plant.reset();
+  for (uint32_t t = 0; t < 3000000; t += plantStepMicros) {
+    plant.update(sweepStart * 0.95 + 5);
+  }
+
+  uint32_t runMicros = (uint32_t)((sweepHold * 2 + sweepSeconds) * 1e6);
+  for (uint32_t t = plantStepMicros; t <= runMicros; t += plantStepMicros) {
+    FakeClock::advanceMicros(plantStepMicros);
+
+    if (t % controlPeriodMicros == 0) {
+      double ramp = (t * 1e-6 - sweepHold) / sweepSeconds;
+      double key = sweepStart + (sweepEnd - sweepStart) * (ramp < 0 ? 0 : ramp > 1 ? 1 : ramp);
+      setpoint = T(key);
+      input = T(plant.getSpeed());
+
+      TimeBase::tick();
+      pid.calculate(TimeBase::now());
+      command = static_cast<double>(output);
+
+      GainSet gains;
+      pid.getGains(gains);
+      double values[4] = {static_cast<double>(gains.kP), static_cast<double>(gains.kI), static_cast<double>(gains.kD), static_cast<double>(gains.feedforward)};
+      double setKey = static_cast<double>(setpoint);
+
+      for (uint8_t c = 0; c < 4; c++) {
+        double error = fabs(values[c] - interpolateSweep(setKey, columns[c]));
+        maxError = error > maxError ? error : maxError;
+
+        if (!first) {
+          double step = fabs(values[c] - lastGains[c]);
+          maxStep = step > maxStep ? step : maxStep;
+          smooth &= step <= maxSlope * fabs(setKey - lastKey) + sweepGainError;
+        }
+        lastGains[c] = values[c];
+      }
+      lastKey = setKey;
+      first = false;
+
+      if (ramp >= 0 && ramp <= 1) {
+        double track = fabs(plant.getSpeed() - key);
+        maxTrack = track > maxTrack ? track : maxTrack;
+      }
+    }
+
+    plant.update(command);
+  }
+
+  bool passed = smooth && maxError <= sweepGainError && maxTrack <= sweepTrackError;
+  printf("%-20s %-8s %10.4f %10.5f %9.2f%s%s%s\n",
+    "schedule sweep", backend, maxStep, maxError, maxTrack,
+    smooth ? "" : "  GAIN JUMP", maxError <= sweepGainError ? "" : "  OFF TABLE", maxTrack <= sweepTrackError ? "" : "  TRACKING");
+
+  return passed;
+}
+
+
+int main() {
+  bool allSettled = true;
+
+  printf("%-20s %-8s %8s %10s %9s %8s %8s %8s\n", "scenario", "backend", "rise s", "overshoot%", "settle s", "IAE", "travel", "ns/step");
+
+  for (uint8_t i = 0; i < numScenarios; i++) {
+    allSettled &= runScenario<double>(scenarios[i], "double");
+    allSettled &= runScenario<Fixed16>(scenarios[i], "Fixed16");
+  }
+
+  printf("\nsetpoint %.0f to %.0f%% over %.0f s through a %u row gain schedule\n", sweepStart, sweepEnd, sweepSeconds, sweepRows);
+  printf("%-20s %-8s %10s %10s %9s\n", "sweep", "backend", "max step", "table err", "track err");
+  allSettled &= runScheduleSweep<double>("double");
+  allSettled &= runScheduleSweep<Fixed16>("Fixed16");
+
+  return allSettled ? 0 : 1;
+}
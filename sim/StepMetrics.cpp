@@ -0,0 +1,69 @@
+#include "StepMetrics.hpp"
+
+/* ---------------------- StepMetrics Methods ---------------------- */
+
+void StepMetrics::begin(double startValue, double targetValue, double settlingBand) {
+  start = startValue;
+  target = targetValue;
+  band = settlingBand;
+
+  riseLow = -1;
+  riseHigh = -1;
+  peak = 0;
+  lastOutside = 0;
+  absError = 0;
+  lastTime = 0;
+  settled = false;
+}
+
+
+void StepMetrics::add(double time, double value) {
+  double step = target - start;
+  double progress = step != 0 ? (value - start) / step : 1; // Fraction of the step covered
+  double error = target - value;
+
+  if (riseLow < 0 && progress >= 0.1) {
+    riseLow = time;
+  }
+  if (riseHigh < 0 && progress >= 0.9) {
+    riseHigh = time;
+  }
+  if (progress > peak) {
+    peak = progress;
+  }
+
+  // Outside the band if the error is bigger than the band (The step size sets the scale)
+  double scale = step < 0 ? -step : step;
+  if (scale == 0) {
+    scale = 1;
+  }
+  settled = (error < 0 ? -error : error) <= band * scale;
+  if (!settled) {
+    lastOutside = time;
+  }
+
+  absError += (error < 0 ? -error : error) * (time - lastTime);
+  lastTime = time;
+}
+
+
+double StepMetrics::getRiseTime() const {
+  return riseHigh < 0 ? -1 : riseHigh - riseLow;
+}
+
+
+double StepMetrics::getOvershoot() const {
+  return peak > 1 ? (peak - 1) * 100 : 0;
+}
+
+
+double StepMetrics::getSettlingTime() const {
+  return settled ? lastOutside : -1;
+}
+
+
+double StepMetrics::getIAE() const {
+  return absError;
+}
+
+/* ----------------------------------------------------------------- */
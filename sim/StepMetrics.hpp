@@ -0,0 +1,79 @@
+#ifndef STEP_METRICS
+#define STEP_METRICS
+
+/*-----------------------------------------------------------------------------*/
+/** @file   StepMetrics.hpp
+ * @brief   Header for StepMetrics class (step-response figures of a simulated run)
+*//*---------------------------------------------------------------------------*/
+
+
+/**
+ * @brief Class used to measure a step response one sample at a time
+ */
+class StepMetrics {
+  private:
+    double start = 0;       // Value before the step
+    double target = 0;      // Setpoint after the step
+    double band = 0.02;     // Settling band as a fraction of the step size
+
+    double riseLow = -1;    // Time the response first passed 10% of the step
+    double riseHigh = -1;   // Time the response first passed 90% of the step
+    double peak = 0;        // Furthest the response went past the start, in the direction of the step
+    double lastOutside = 0; // Last time the response was outside the settling band
+    double absError = 0;    // Integral of the absolute error
+    double lastTime = 0;    // Time of the previous sample
+    bool settled = false;   // Condition for if the latest sample was inside the settling band
+
+  public:
+    /**
+     * @brief Starts measuring a step at time 0
+     * 
+     * @param startValue Value before the step
+     * @param targetValue Setpoint after the step
+     * @param settlingBand Settling band as a fraction of the step size (Default 0.02)
+     */
+    void begin(double startValue, double targetValue, double settlingBand = 0.02);
+
+
+    /**
+     * @brief Adds a sample of the response
+     * 
+     * @param time Time since the step in seconds
+     * @param value Value of the response
+     */
+    void add(double time, double value);
+
+
+    /**
+     * @brief Gets the 10% to 90% rise time
+     * 
+     * @return Rise time in seconds (-1 if the response never reached 90%)
+     */
+    double getRiseTime() const;
+
+
+    /**
+     * @brief Gets the overshoot
+     * 
+     * @return Overshoot as a percentage of the step size
+     */
+    double getOvershoot() const;
+
+
+    /**
+     * @brief Gets the settling time
+     * 
+     * @return Time the response last entered the settling band in seconds (-1 if it ended outside)
+     */
+    double getSettlingTime() const;
+
+
+    /**
+     * @brief Gets the integrated absolute error
+     * 
+     * @return Integral of |setpoint - value| over the run
+     */
+    double getIAE() const;
+};
+
+#endif // STEP_METRICS
@@ -1,125 +1,367 @@
 // External Libraries 
 #include <Arduino.h>
-#include <Servo.h>
 
 // Custom Libraries
 #include <ControlRC.hpp>
-#include <SlewRateLimiter.hpp>
+#include <IntSlewRateLimiter.hpp>
+#include <TaskScheduler.hpp>
+#include <LoopProfiler.hpp>
+#include <Telemetry.hpp>
+#include <EscPwm.hpp>
+#include <ParamStore.hpp>
+#include <TuningLink.hpp>
+#include <SampleCapture.hpp>
 
 
 /** 
  * General Reminders:
  *   1. Unplug the reciever from pin 0 (RX) when uploading code
- *   2. Run the serial monitor at a baudrate of 115200 to work properly
+ *   2. Output is binary telemetry at 115200 baud, so read it with tools/telemetry_decode.py instead of the 
+ *      serial monitor, and change settings live with tools/tune.py (See the README)
  * 
  * For the GitHub page, go to https://github.com/Nyx3815/Adjustable-Runway
 **/ 
 
 
-const double sampleRate = 5; // Number of receiver samples per second
+const uint32_t controlPeriod = 20000;  // Time between motor updates in microseconds
 ControlRC rcTest;
+TaskScheduler scheduler;
+int8_t sampleTaskId = -1;
+int8_t profileTaskId = -1;
+
+/**
+ * @brief Settings kept in EEPROM, so they can change without a reflash
+ * 
+ * @note Change paramsVersion whenever a field is added, removed, or reordered
+ */
+struct Params {
+  int joystickMap[2];        // Maps the standard joysticks
+  int throttleMap[2];        // Maps the throttle joystick
+  int switchMap[2];          // Maps the basic switches
+  int cSwitchMap[3];         // Maps the SWC switch
+  int knobMap[2];            // Maps the knobs
+  uint32_t motorChangeLimit; // Maximum change of the motor output per second
+  uint32_t failsafeRampRate; // Motor output change per second while ramping down in failsafe
+  uint16_t sampleRate;       // Number of checks for a new receiver frame per second
+};
+
+const uint16_t paramsVersion = 1;
 
 // Note >> Currently, mapped for motor control using an esc
-const int joysitckMap[2] = {0, 180};    // Maps the standard joysticks
-const int throttleMap[2] = {0, 180};    // Maps the throttle joystick
-const int switchMap[2] = {0, 180};      // Maps the basic switches
-const int cSwitchMap[3] = {0, 90, 180}; // Maps the SWC switch
-const int knobMap[2] = {0, 180};        // Maps the knobs
+const uint32_t defaultMotorChangeLimit = 30;
+const uint32_t defaultFailsafeRampRate = 90;
+const uint16_t defaultSampleRate = 1000;
+const uint32_t minFailsafeRampRate = 45; // Lowest failsafe ramp rate tools/tune.py can set
+const uint16_t minSampleRate = 250;      // Lowest sample rate tools/tune.py can set
+
+// Without IBUS_UART_ISR the sample task empties HardwareSerial's receive buffer, which overflows (Dropping
+// iBus frames and tuning requests) if it goes a full buffer of back to back bytes without a poll
+const uint32_t byteMicros = 10UL * 1000000UL / ControlRC::iBusBaudrate; // Time of one byte with its start and stop bits
+static_assert(1000000UL / minSampleRate * 4 <= SERIAL_RX_BUFFER_SIZE * byteMicros * 3,
+  "The slowest tunable sample rate has to poll within 3/4 of the time it takes to fill the serial receive buffer");
+const Params defaultParams PROGMEM = {
+  {0, 180},     // joystickMap
+  {0, 180},     // throttleMap
+  {0, 180},     // switchMap
+  {0, 90, 180}, // cSwitchMap
+  {0, 180},     // knobMap
+  defaultMotorChangeLimit,
+  defaultFailsafeRampRate,
+  defaultSampleRate
+};
 
-const int motorPin = 3; 
+Params params; // Settings in use, loaded from EEPROM in setup()
+ParamStore paramStore(&params, &defaultParams, sizeof(Params), paramsVersion);
+
+// Settings that can be changed live with tools/tune.py, the index is the parameter ID (Keep tune.py in the same order)
+const TuningLink::Param tunables[] PROGMEM = {
+  {&params.joystickMap[0],   TuningLink::INT,    -1000, 1000},
+  {&params.joystickMap[1],   TuningLink::INT,    -1000, 1000},
+  {&params.throttleMap[0],   TuningLink::INT,    -1000, 1000},
+  {&params.throttleMap[1],   TuningLink::INT,    -1000, 1000},
+  {&params.switchMap[0],     TuningLink::INT,    -1000, 1000},
+  {&params.switchMap[1],     TuningLink::INT,    -1000, 1000},
+  {&params.cSwitchMap[0],    TuningLink::INT,    -1000, 1000},
+  {&params.cSwitchMap[1],    TuningLink::INT,    -1000, 1000},
+  {&params.cSwitchMap[2],    TuningLink::INT,    -1000, 1000},
+  {&params.knobMap[0],       TuningLink::INT,    -1000, 1000},
+  {&params.knobMap[1],       TuningLink::INT,    -1000, 1000},
+  {&params.motorChangeLimit, TuningLink::UINT32, 1,     1000},
+  {&params.failsafeRampRate, TuningLink::UINT32, minFailsafeRampRate, 1000}, // Bounded so the failsafe stops the motor within tunedStopTimeLimit
+  {&params.sampleRate,       TuningLink::UINT16, minSampleRate,       2000}
+};
+Params paramSnapshot; // Copy of params the tuning REVERT command goes back to
+const uint32_t tuningPeriod = 4000; // Time between tuning request checks in microseconds (About one EEPROM byte write)
+
+const EscPwm::Channel escOutput = EscPwm::OUTPUT_A; // ESC signal on pin 9 (Timer1 OC1A)
+const uint16_t escRate = 50; // ESC pulses per second (50 to 400, check what the ESC accepts)
+const Fixed16 maxMotorSpeed = Fixed16(180);           // Motor speed at full throttle
+const Fixed16 throttlePerSpeed = Fixed16(1.0 / 180);  // Throttle of one motor speed unit (Multiplied instead of dividing)
 int motorSpeed = 0;
+int switchSpeed = 0;        // Motor speed selected by the speed switch
 bool enableMotor = false;
-ChannelRC enableChannel = ChannelRC::SWD;
-
-double currentTime;
-double lastSample;
-double lastBlink;
+bool enableSwitchOn = false; // Position of the enable switch, updated by its edge handler
+const ChannelRC enableChannel = ChannelRC::SWD;
 
-const int ledPin = 2;     // LED pin
-const double ledFreq = 1; // Blinks per second
+const int ledPin = 2;       // LED pin
+const uint32_t ledFreq = 1; // Blinks per second
 bool ledState = false;
 
-const double motorChangeLimit = 30;
 bool isRateLimited = true;
-SlewRateLimiter rateLimit(motorChangeLimit); // Creates a SlewRateLimiter with a maximum change limit defined above 
-ChannelRC limiterChannel = ChannelRC::SWA;
+bool limiterSwitchOn = false; // Position of the limiter switch (On turns the limiter off), updated by its edge handler
+IntSlewRateLimiter rateLimit(defaultMotorChangeLimit); // Creates an integer-only slew rate limiter, set to params.motorChangeLimit in setup()
+const ChannelRC limiterChannel = ChannelRC::SWA;
+
+// Signal loss (Worst case from the last frame to the motor stopped is maxStopTime, with the default params)
+const uint32_t signalTimeout = 100000;   // Time without a frame before the failsafe in microseconds
+const uint32_t maxStopTime = signalTimeout + 1000000UL / defaultSampleRate + controlPeriod + 180UL * 1000000UL / defaultFailsafeRampRate;
+const uint32_t maxTunedStopTime = signalTimeout + 1000000UL / minSampleRate + controlPeriod + 180UL * 1000000UL / minFailsafeRampRate;
+const uint32_t stopTimeLimit = 2500000;      // Longest allowed time to stop with the default params in microseconds
+const uint32_t tunedStopTimeLimit = 4200000; // Longest allowed time to stop with any tuned params in microseconds
+static_assert(maxStopTime <= stopTimeLimit, "The default params don't stop the motor within stopTimeLimit after signal loss");
+static_assert(maxTunedStopTime <= tunedStopTimeLimit, "The tunable ranges allow a stop time past tunedStopTimeLimit after signal loss");
+bool inFailsafe = false;
+
+const ChannelRC testChannel = ChannelRC::SWC;
+
+// Profiled stages of the loop (Build the uno_profile environment to enable)
+enum ProfileStage { RC_UPDATE = 0, RATE_LIMIT, SERIAL_OUTPUT, ESC_WRITE };
+const uint32_t profileDumpPeriod = 5000000;  // Time between profiler dumps in microseconds
+const uint32_t profileRecordPeriod = 20000;  // Time between records during a dump in microseconds
+bool profileStagesSent = false;              // Condition for if the current dump has sent every stage
 
-Servo esc;
-ChannelRC testChannel = ChannelRC::SWC;
+const uint32_t channelTelemetryPeriod = 100000; // Time between RC channel telemetry records in microseconds
+
+// Capture of the motor task around speed changes and signal loss, dumped as telemetry once it is over
+enum CaptureChannel { CAPTURE_TARGET = 0, CAPTURE_ERROR, CAPTURE_OUTPUT, CAPTURE_SPEED_SWITCH, CAPTURE_INTERVAL, numCaptureChannels };
+const uint16_t captureDepth = 40;          // Samples per capture, 0.8 s at the motor task rate (400 bytes of RAM)
+const uint16_t capturePreTrigger = 10;     // Samples kept from before the trigger
+const int16_t captureErrorLevel = 45;      // Rate limiter lag that triggers a capture
+const uint32_t captureDumpPeriod = 20000;  // Time between dumped samples in microseconds
+SampleCapture<numCaptureChannels, captureDepth> capture(capturePreTrigger);
+TimeMicros lastMotorTime;
 
 
 /**
- * @brief One time setup code
+ * @brief Receives and updates the RC channels
  */
-void setup() {
-  Serial.begin(ControlRC::iBusBaudrate);
-  while (!Serial) { delay(20); } // Wait for the Serial port to open 
+void sampleTask() {
+  PROFILE_SCOPE(ProfileStage::RC_UPDATE);
+  rcTest.update();
+}
 
-  // Set up the esc and set the initial speed to 0
-  esc.attach(motorPin, 1000, 2000);
-  esc.write(motorSpeed);
 
-  // Set up the LED 
-  pinMode(ledPin, OUTPUT);
-  digitalWrite(ledPin, ledState);
+/**
+ * @brief Tracks the enable and rate limiter switches when they move
+ */
+void onSwitchEdge(ChannelRC channel, uint8_t position, ControlRC::SwitchEdge edge) {
+  if (channel == enableChannel) {
+    enableSwitchOn = edge == ControlRC::SwitchEdge::RISING && position != 0;
+  } else if (channel == limiterChannel) {
+    limiterSwitchOn = edge == ControlRC::SwitchEdge::RISING && position != 0;
+  }
+}
 
-  // Set the mapping arrays for the values
-  rcTest.setMapping(joysitckMap, ControlRC::mapType::JOYSTICK);
-  rcTest.setMapping(throttleMap, ControlRC::mapType::THROTTLE);
-  rcTest.setMapping(switchMap, ControlRC::mapType::SWITCH);
-  rcTest.setMapping(cSwitchMap, ControlRC::mapType::C_SWITCH);
-  rcTest.setMapping(knobMap, ControlRC::mapType::KNOB);
 
-  // Set up the time variables 
-  currentTime = millis();
-  lastBlink = currentTime;
+/**
+ * @brief Maps the speed switch to a motor speed with the saved C_SWITCH mapping when it moves
+ */
+void onSpeedSwitch(ChannelRC, uint8_t, ControlRC::SwitchEdge) {
+  switchSpeed = rcTest.getChannelValue(testChannel);
 }
 
 
 /**
- * @brief Main code loop
+ * @brief Updates and writes the motor enable, speed, and rate limiter states
  */
-void loop() {
-  // Updates the current time in since start 
-  currentTime = millis();
+void motorTask() {
+  // Ramps down faster than normal, but still ramps, once the signal is lost
+  if (rcTest.isFailsafe() != inFailsafe) {
+    inFailsafe = rcTest.isFailsafe();
+    rateLimit.setRate(params.motorChangeLimit, inFailsafe ? params.failsafeRampRate : params.motorChangeLimit);
 
-  // Updates the values of each channel at the start of the loop 
-  if ((currentTime - lastSample) >= (1000 * (1 / sampleRate))) {
-    rcTest.update();
-    lastSample = currentTime;
+    // Captures the ramp down when the signal is lost with the motor running
+    if (inFailsafe && motorSpeed > 0) {
+      capture.trigger();
+    }
   }
 
-  // Updates the motor enable state and rate limiter state
-  enableMotor = rcTest.getChannelValue(enableChannel, ControlRC::mapSwitches);
-  isRateLimited = !rcTest.getChannelValue(limiterChannel, ControlRC::mapSwitches);
+  // Updates the motor enable state and rate limiter state (Only once armed from zeroed controls)
+  enableMotor = rcTest.isArmed() && enableSwitchOn;
+  isRateLimited = inFailsafe || !limiterSwitchOn;
   
   // Writes to the motor using the SWD switch as enable and SWC switch as velocities
+  int targetSpeed = enableMotor ? switchSpeed : 0;
+  {
+    PROFILE_SCOPE(ProfileStage::RATE_LIMIT);
+    if (isRateLimited) {
+      motorSpeed = rateLimit.calculate(targetSpeed, TimeBase::now());
+    } else {
+      motorSpeed = targetSpeed;
+      rateLimit.reset(motorSpeed); // Keeps the limiter at the motor speed so a failsafe ramps from here
+    }
+  }
+
   if (enableMotor) {
-    motorSpeed = isRateLimited ? rateLimit.calculate(rcTest.getChannelValue(testChannel)) : rcTest.getChannelValue(testChannel);
-
-    Serial.print("Motor Output - ");
-    Serial.print(motorSpeed);
-    Serial.print(" units\t| ");
-    Serial.print(map(motorSpeed, joysitckMap[0], joysitckMap[1], 0, 100));
-    Serial.println("%");
-  } else {
-    motorSpeed = isRateLimited ? rateLimit.calculate(0) : 0;
+    PROFILE_SCOPE(ProfileStage::SERIAL_OUTPUT);
+    int16_t motorSample[2] = {(int16_t)motorSpeed, (int16_t)map(motorSpeed, params.joystickMap[0], params.joystickMap[1], 0, 100)};
+    Telemetry::send(Telemetry::MOTOR, 0, motorSample, 2); // Output units and percent, dropped if the link is busy
   }
 
-  // Set the LED state 
-  if (enableMotor) { // Blinks the LED if the motor is enabled
-    if ((currentTime - lastBlink) >= (500 * (1 / ledFreq))) {
-      ledState = !ledState;
-      lastBlink = currentTime;
-    }
-  } else { // Keeps the LED solid if the motor isn't enabled 
-    ledState = true;
+  // Records the task at its full rate, the trigger is checked on every sample
+  int16_t sample[numCaptureChannels];
+  sample[CAPTURE_TARGET] = targetSpeed;
+  sample[CAPTURE_ERROR] = targetSpeed - motorSpeed;
+  sample[CAPTURE_OUTPUT] = motorSpeed;
+  sample[CAPTURE_SPEED_SWITCH] = rcTest.getChannelValue(testChannel, false);
+  uint32_t interval = TimeBase::elapsed(lastMotorTime);
+  sample[CAPTURE_INTERVAL] = interval < 32767 ? interval : 32767; // Saturates at 32.7 ms
+  lastMotorTime = TimeBase::now();
+  capture.record(sample);
+
+  PROFILE_SCOPE(ProfileStage::ESC_WRITE);
+  // Scales the limiter's value with its fractional bits, so a ramp moves the pulse in steps of 1/256 of a unit 
+  // instead of 1 of 180. It matches motorSpeed when unlimited, since the limiter is reset to it
+  Fixed16 exactSpeed = constrain(rateLimit.getFixedValue(), Fixed16(0), maxMotorSpeed); // Constrained incase of weird errors
+  EscPwm::writeThrottle(escOutput, exactSpeed * throttlePerSpeed);
+}
+
+
+/**
+ * @brief Blinks the LED while the motor is enabled and keeps it solid otherwise
+ */
+void ledTask() {
+  ledState = enableMotor ? !ledState : true;
+  digitalWrite(ledPin, ledState);
+}
+
+
+/**
+ * @brief Sends the raw RC channels as a telemetry record
+ */
+void channelTelemetryTask() {
+  Telemetry::send(Telemetry::CHANNELS, 0, rcTest.getValueArray(), numChannels);
+}
+
+
+/**
+ * @brief Sends a finished capture one sample at a time, then arms it again
+ */
+void captureTask() {
+  if (capture.getState() == capture.DONE && !capture.dumpNext()) {
+    capture.arm();
+  }
+}
+
+
+/**
+ * @brief Runs tuning requests and continues saving params
+ */
+void tuningTask() {
+  TuningLink::poll();
+}
+
+
+/**
+ * @brief Passes the params on to the RC mapping, rate limiter, and scheduler
+ */
+void applyParams(uint8_t = TuningLink::allParams) {
+  rcTest.setMapping(params.joystickMap, ControlRC::mapType::JOYSTICK);
+  rcTest.setMapping(params.throttleMap, ControlRC::mapType::THROTTLE);
+  rcTest.setMapping(params.switchMap, ControlRC::mapType::SWITCH);
+  rcTest.setMapping(params.cSwitchMap, ControlRC::mapType::C_SWITCH);
+  rcTest.setMapping(params.knobMap, ControlRC::mapType::KNOB);
+  switchSpeed = rcTest.getChannelValue(testChannel); // A tuned speed takes effect without moving the switch
+
+  rateLimit.setRate(params.motorChangeLimit, inFailsafe ? params.failsafeRampRate : params.motorChangeLimit);
+
+  // A copy saved while the tunable range went lower could still hold a rate that overflows the receive buffer
+  if (params.sampleRate < minSampleRate) {
+    params.sampleRate = minSampleRate;
+  }
+  scheduler.setPeriod(sampleTaskId, 1000000UL / params.sampleRate);
+}
+
+
+/**
+ * @brief Sends the loop stage timings and task counters as telemetry, one record per run
+ */
+void profileTask() {
+  // Stages go first, then the tasks
+  if (!profileStagesSent) {
+    profileStagesSent = !PROFILE_DUMP_NEXT();
   }
 
-  // Sets the LED and motor to their current states 
+  // Runs faster while a dump is going, so the records trickle out between the motor records
+  if (!profileStagesSent || scheduler.dumpNextStats()) {
+    scheduler.setPeriod(profileTaskId, profileRecordPeriod);
+    return;
+  }
+
+  PROFILE_RESET();
+  scheduler.resetStats();
+  scheduler.setPeriod(profileTaskId, profileDumpPeriod);
+  profileStagesSent = false;
+}
+
+
+/**
+ * @brief One time setup code
+ */
+void setup() {
+  // Loads the saved settings, or the defaults if there are none
+  paramStore.load();
+
+  rcTest.begin(); // Begins iBus reception on the UART
+  rcTest.setSignalTimeout(signalTimeout);
+
+  // Switch handlers, called by rcTest.update() only when a switch moves
+  rcTest.onSwitch(enableChannel, onSwitchEdge);
+  rcTest.onSwitch(limiterChannel, onSwitchEdge);
+  rcTest.onSwitch(testChannel, onSpeedSwitch);
+
+  // Set up the esc with 1000 to 2000 us pulses, attach() starts it at zero throttle
+  EscPwm::begin(escRate, 1000, 2000);
+  EscPwm::attach(escOutput);
+
+  // Set up the LED 
+  pinMode(ledPin, OUTPUT);
   digitalWrite(ledPin, ledState);
-  esc.write(constrain(motorSpeed, 0, 180)); // Constrains the motor speed incase of weird errors
 
-  // Delays the code to not overload the Arduino
-  delay(20);
+  // Set up the tasks, lower priority values run first when several are due
+  sampleTaskId = scheduler.addTask(sampleTask, 1000000UL / params.sampleRate, 0);
+  scheduler.addTask(motorTask, controlPeriod, 1);
+  scheduler.addTask(ledTask, 500000UL / ledFreq, 2);
+  scheduler.addTask(channelTelemetryTask, channelTelemetryPeriod, 2);
+  scheduler.addTask(tuningTask, tuningPeriod, 2);
+  scheduler.addTask(captureTask, captureDumpPeriod, 3);
+
+  // Captures when the motor lags its target by captureErrorLevel, or the signal is lost
+  capture.setTrigger(CAPTURE_ERROR, capture.MAGNITUDE_ABOVE, captureErrorLevel);
+  capture.arm();
+
+  // Set the mapping arrays and rates, and again whenever a param is tuned
+  applyParams();
+  TuningLink::begin(tunables, sizeof(tunables) / sizeof(tunables[0]), paramStore, &paramSnapshot, applyParams);
+
+#ifdef LOOP_PROFILER
+  // Names the profiled stages with their time budgets in microseconds
+  PROFILE_SET_STAGE(ProfileStage::RC_UPDATE, "rc update", 200);
+  PROFILE_SET_STAGE(ProfileStage::RATE_LIMIT, "rate limit", 100);
+  PROFILE_SET_STAGE(ProfileStage::SERIAL_OUTPUT, "serial output", 1000);
+  PROFILE_SET_STAGE(ProfileStage::ESC_WRITE, "esc write", 100);
+  profileTaskId = scheduler.addTask(profileTask, profileDumpPeriod, 3);
+#endif
+}
+
+
+/**
+ * @brief Main code loop
+ */
+void loop() {
+  // Runs whichever task is due next, nothing here blocks
+  scheduler.run();
+
+  // Sends whatever telemetry fits in the Serial transmit buffer
+  Telemetry::poll();
 }
\ No newline at end of file
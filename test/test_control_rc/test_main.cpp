@@ -0,0 +1,183 @@
+#include <Arduino.h>
+#include <FakeClock.hpp>
+#include <FakeIBus.hpp>
+#include <unity.h>
+
+#include <ControlRC.hpp>
+
+/*-----------------------------------------------------------------------------*/
+/** @file   test_main.cpp
+ * @brief   ControlRC mapping, failsafe, arming and median filter checks on real iBus frames
+*//*---------------------------------------------------------------------------*/
+
+
+FakeIBus receiver;
+
+
+/**
+ * @brief Sets the receiver to zeroed controls (Joysticks centered, throttle, switches and knobs low)
+ */
+void zeroControls() {
+  for (uint8_t i = 0; i < FakeIBus::numChannels; i++) {
+    receiver.setChannel(i, minRC);
+  }
+  receiver.setChannel(RIGHT_X, midRC);
+  receiver.setChannel(RIGHT_Y, midRC);
+  receiver.setChannel(LEFT_X, midRC);
+}
+
+
+/**
+ * @brief Sends one frame of the current receiver values and updates ControlRC with it
+ *
+ * @param rc ControlRC to update
+ * @return Condition for if update() read a new frame
+ */
+bool sendFrame(ControlRC &rc) {
+  uint8_t frame[32];
+  receiver.encodeFrame(frame);
+  Serial.inject(frame, sizeof(frame));
+
+  FakeClock::advanceMicros(FakeIBus::framePeriod);
+  return rc.update();
+}
+
+
+void setUp() {
+  FakeClock::setMicros(0);
+  zeroControls();
+}
+
+
+void tearDown() {}
+
+
+void test_runtime_mapping() {
+  ControlRC rc;
+  const int joystickMap[2] = {-100, 100};
+  const int cSwitchMap[3] = {0, 90, 180};
+  rc.setMapping(joystickMap, ControlRC::JOYSTICK);
+  rc.setMapping(cSwitchMap, ControlRC::C_SWITCH);
+
+  receiver.setChannel(RIGHT_X, maxRC);
+  receiver.setChannel(RIGHT_Y, 1250);
+  receiver.setChannel(SWC, midRC);
+  TEST_ASSERT_TRUE(sendFrame(rc));
+
+  TEST_ASSERT_EQUAL_INT(100, rc.getChannelValue(RIGHT_X));
+  TEST_ASSERT_EQUAL_INT(-50, rc.getChannelValue(RIGHT_Y));
+  TEST_ASSERT_EQUAL_INT(0, rc.getChannelValue(LEFT_X));
+  TEST_ASSERT_EQUAL_INT(90, rc.getChannelValue(SWC));
+  TEST_ASSERT_EQUAL_INT(1250, rc.getChannelValue(RIGHT_Y, false));
+}
+
+
+void test_compile_time_mapping() {
+  ControlRC rc;
+  receiver.setChannel(LEFT_Y, 1500);
+  receiver.setChannel(SWC, maxRC);
+  TEST_ASSERT_TRUE(sendFrame(rc));
+
+  TEST_ASSERT_EQUAL_INT(50, (rc.get<LEFT_Y, MapRC<0, 100> >()));
+  TEST_ASSERT_EQUAL_INT(180, (rc.get<SWC, MapRC<0, 90, 180> >()));
+  TEST_ASSERT_EQUAL_INT(-100, (MapRC<100, -100>::apply(maxRC)));
+}
+
+
+void test_arms_from_zeroed_controls() {
+  ControlRC rc;
+  TEST_ASSERT_TRUE(rc.isFailsafe());
+  TEST_ASSERT_FALSE(rc.isArmed());
+
+  // A switch already on at the first frame doesn't arm
+  receiver.setChannel(SWD, maxRC);
+  TEST_ASSERT_TRUE(sendFrame(rc));
+  TEST_ASSERT_FALSE(rc.isFailsafe());
+  TEST_ASSERT_FALSE(rc.isArmed());
+
+  receiver.setChannel(SWD, minRC);
+  TEST_ASSERT_TRUE(sendFrame(rc));
+  TEST_ASSERT_TRUE(rc.isArmed());
+
+  // Stays armed once the switch turns on
+  receiver.setChannel(SWD, maxRC);
+  TEST_ASSERT_TRUE(sendFrame(rc));
+  TEST_ASSERT_TRUE(rc.isArmed());
+}
+
+
+void test_failsafe_after_timeout() {
+  ControlRC rc;
+  rc.setSignalTimeout(50000);
+  TEST_ASSERT_TRUE(sendFrame(rc));
+
+  receiver.setChannel(RIGHT_X, maxRC);
+  receiver.setChannel(LEFT_Y, 1800);
+  receiver.setChannel(SWD, maxRC);
+  TEST_ASSERT_TRUE(sendFrame(rc));
+  TEST_ASSERT_TRUE(rc.isArmed());
+
+  // Just inside the timeout nothing changes
+  FakeClock::advanceMicros(49000);
+  TEST_ASSERT_FALSE(rc.update());
+  TEST_ASSERT_FALSE(rc.isFailsafe());
+
+  FakeClock::advanceMicros(2000);
+  TEST_ASSERT_FALSE(rc.update());
+  TEST_ASSERT_TRUE(rc.isFailsafe());
+  TEST_ASSERT_FALSE(rc.isArmed());
+  TEST_ASSERT_EQUAL_INT(midRC, rc.getChannelValue(RIGHT_X, false));
+  TEST_ASSERT_EQUAL_INT(minRC, rc.getChannelValue(LEFT_Y, false));
+  TEST_ASSERT_EQUAL_INT(minRC, rc.getChannelValue(SWD, false));
+
+  // Signal back with the switch still on stays disarmed
+  TEST_ASSERT_TRUE(sendFrame(rc));
+  TEST_ASSERT_FALSE(rc.isFailsafe());
+  TEST_ASSERT_FALSE(rc.isArmed());
+}
+
+
+void test_median_filter_removes_spike() {
+  ControlRC rc;
+  ChannelFilter filter(ChannelFilter::MEDIAN_3);
+  rc.setFilter(RIGHT_X, &filter);
+
+  // A single-frame spike never shows, a lasting change shows one frame late
+  const uint16_t values[] = {1500, 1500, 2000, 1500, 1500, 1600, 1600};
+  const int16_t expected[] = {1500, 1500, 1500, 1500, 1500, 1500, 1600};
+
+  for (uint8_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+    receiver.setChannel(RIGHT_X, values[i]);
+    TEST_ASSERT_TRUE(sendFrame(rc));
+    TEST_ASSERT_EQUAL_INT(expected[i], rc.getChannelValue(RIGHT_X, false));
+  }
+}
+
+
+void test_bad_checksum_is_dropped() {
+  ControlRC rc;
+  TEST_ASSERT_TRUE(sendFrame(rc));
+  uint16_t badFrames = IBusUart::decoder.getBadFrames();
+
+  uint8_t frame[32];
+  receiver.setChannel(RIGHT_X, maxRC);
+  receiver.encodeFrame(frame);
+  frame[30] ^= 0x01;
+  Serial.inject(frame, sizeof(frame));
+
+  TEST_ASSERT_FALSE(rc.update());
+  TEST_ASSERT_EQUAL_INT(badFrames + 1, IBusUart::decoder.getBadFrames());
+  TEST_ASSERT_EQUAL_INT(midRC, rc.getChannelValue(RIGHT_X, false));
+}
+
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_runtime_mapping);
+  RUN_TEST(test_compile_time_mapping);
+  RUN_TEST(test_arms_from_zeroed_controls);
+  RUN_TEST(test_failsafe_after_timeout);
+  RUN_TEST(test_median_filter_removes_spike);
+  RUN_TEST(test_bad_checksum_is_dropped);
+  return UNITY_END();
+}
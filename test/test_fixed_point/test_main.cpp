@@ -0,0 +1,130 @@
+#include <Arduino.h>
+#include <unity.h>
+
+#include <FixedPoint.hpp>
+
+/*-----------------------------------------------------------------------------*/
+/** @file   test_main.cpp
+ * @brief   FixedPoint multiply and divide checks (Including the AVR narrow versions) against 64 bit reference results
+*//*---------------------------------------------------------------------------*/
+
+
+const int32_t edgeValues[] = {
+  0, 1, -1, 2, -2, 0x7FFF, 0x8000, -0x8000, 0xFFFF, 0x10000, -0x10000, 0x10001, 0x12345678, -0x12345678,
+  0x7FFFFFFF, -0x7FFFFFFF, (int32_t)0x80000000, 0x00FFFFFF, -0x00FFFFFF, 0x40000000, -0x40000000
+};
+
+uint32_t randomState = 1;
+
+
+/**
+ * @brief Gets the next value of a xorshift generator, spread across every magnitude
+ */
+int32_t nextRandom() {
+  randomState ^= randomState << 13;
+  randomState ^= randomState >> 17;
+  randomState ^= randomState << 5;
+
+  // Shifts by a random amount so small values come up as often as large ones
+  return (int32_t)randomState >> (randomState & 31);
+}
+
+
+/**
+ * @brief Saturating rounded product computed with 64 bit math
+ */
+template <uint8_t FracBits>
+int32_t referenceMultiply(int32_t a, int32_t b) {
+  int64_t product = ((int64_t)a * b + ((int64_t)1 << (FracBits - 1))) >> FracBits;
+  return product > INT32_MAX ? INT32_MAX : product < INT32_MIN ? INT32_MIN : (int32_t)product;
+}
+
+
+/**
+ * @brief Saturating truncated quotient computed with 64 bit math
+ */
+template <uint8_t FracBits>
+int32_t referenceDivide(int32_t a, int32_t b) {
+  if (b == 0) {
+    return a < 0 ? INT32_MIN : INT32_MAX;
+  }
+
+  int64_t quotient = ((int64_t)a << FracBits) / b;
+  return quotient > INT32_MAX ? INT32_MAX : quotient < INT32_MIN ? INT32_MIN : (int32_t)quotient;
+}
+
+
+/**
+ * @brief Checks one pair of raw values through the operators and the narrow versions
+ *
+ * @return Condition for if every result matches the reference
+ */
+template <uint8_t FracBits>
+bool matchesReference(int32_t a, int32_t b) {
+  typedef FixedPoint<FracBits> Fixed;
+  Fixed x = Fixed::fromRaw(a), y = Fixed::fromRaw(b);
+
+  int32_t product = referenceMultiply<FracBits>(a, b);
+  int32_t quotient = referenceDivide<FracBits>(a, b);
+
+  return (x * y).getRaw() == product && Fixed::narrowMultiply(x, y).getRaw() == product
+      && (x / y).getRaw() == quotient && Fixed::narrowDivide(x, y).getRaw() == quotient;
+}
+
+
+/**
+ * @brief Checks every pair of edge values and a million random pairs
+ */
+template <uint8_t FracBits>
+void checkAgainstReference() {
+  const uint8_t edgeCount = sizeof(edgeValues) / sizeof(edgeValues[0]);
+
+  for (uint8_t i = 0; i < edgeCount; i++) {
+    for (uint8_t j = 0; j < edgeCount; j++) {
+      TEST_ASSERT_TRUE_MESSAGE((matchesReference<FracBits>(edgeValues[i], edgeValues[j])), "edge values");
+    }
+  }
+
+  randomState = 1;
+  uint32_t mismatches = 0;
+  for (uint32_t i = 0; i < 1000000; i++) {
+    int32_t a = nextRandom();
+    int32_t b = nextRandom();
+    mismatches += !matchesReference<FracBits>(a, b);
+  }
+  TEST_ASSERT_EQUAL_INT(0, mismatches);
+}
+
+
+void setUp() {}
+
+
+void tearDown() {}
+
+
+void test_q16_matches_reference() { checkAgainstReference<16>(); }
+void test_q8_matches_reference() { checkAgainstReference<8>(); }
+void test_q1_matches_reference() { checkAgainstReference<1>(); }
+void test_q30_matches_reference() { checkAgainstReference<30>(); }
+
+
+void test_values() {
+  TEST_ASSERT_FLOAT_WITHIN(0.0001, 7.5, static_cast<double>(Fixed16(2.5) * Fixed16(3)));
+  TEST_ASSERT_FLOAT_WITHIN(0.0001, -7.5, static_cast<double>(Fixed16(-2.5) * Fixed16(3)));
+  TEST_ASSERT_FLOAT_WITHIN(0.0001, 0.5, static_cast<double>(Fixed16(90) / Fixed16(180)));
+  TEST_ASSERT_FLOAT_WITHIN(0.0001, -1.0 / 3, static_cast<double>(Fixed16(1) / Fixed16(-3)));
+  TEST_ASSERT_TRUE(Fixed16(30000) * Fixed16(3) == Fixed16::maxValue());
+  TEST_ASSERT_TRUE(Fixed16(-30000) / Fixed16(0.25) == Fixed16::minValue());
+  TEST_ASSERT_TRUE(Fixed16(1) / Fixed16(0) == Fixed16::maxValue());
+}
+
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_q16_matches_reference);
+  RUN_TEST(test_q8_matches_reference);
+  RUN_TEST(test_q1_matches_reference);
+  RUN_TEST(test_q30_matches_reference);
+  RUN_TEST(test_values);
+  return UNITY_END();
+}
@@ -0,0 +1,183 @@
+#include <Arduino.h>
+#include <FakeClock.hpp>
+#include <FakeIBus.hpp>
+#include <unity.h>
+
+#include <IBusUart.hpp>
+
+/*-----------------------------------------------------------------------------*/
+/** @file   test_main.cpp
+ * @brief   Side channel routing and frame reading checks for IBusUart on the fake Serial port
+*//*---------------------------------------------------------------------------*/
+
+
+const uint8_t sideSync = 0xA5;        // Sync byte of the test side channel
+const uint8_t sideLength = 3;         // Bytes in a test side channel frame, sync included
+const uint32_t byteMicros = 87;       // Time of one byte at 115200 baud
+
+FakeIBus receiver;
+uint8_t sideBytes = 0;                // Bytes the side channel handler received
+uint8_t sideFirst = 0;                // First byte of the latest side channel frame
+
+
+/**
+ * @brief Side channel handler that takes fixed length frames
+ */
+bool countSideByte(uint8_t data) {
+  if (sideBytes % sideLength == 0) {
+    sideFirst = data;
+  }
+
+  sideBytes++;
+  return sideBytes % sideLength != 0;
+}
+
+
+/**
+ * @brief Sends bytes one at a time as a UART would, polling twice per byte like a fast loop
+ *
+ * @param data Bytes to send
+ * @param length Number of bytes
+ */
+void sendBytes(const uint8_t *data, uint8_t length) {
+  for (uint8_t i = 0; i < length; i++) {
+    FakeClock::advanceMicros(byteMicros / 2);
+    IBusUart::poll();
+    FakeClock::advanceMicros(byteMicros - byteMicros / 2);
+    Serial.inject(&data[i], 1);
+    IBusUart::poll();
+  }
+}
+
+
+/**
+ * @brief Leaves the line quiet for a time, polling through it
+ *
+ * @param quietMicros Time to stay quiet
+ */
+void waitQuiet(uint32_t quietMicros) {
+  for (uint32_t t = 0; t < quietMicros; t += 100) {
+    FakeClock::advanceMicros(100);
+    IBusUart::poll();
+  }
+}
+
+
+void setUp() {
+  FakeClock::setMicros(0);
+  IBusUart::setSideChannel(sideSync, countSideByte);
+  sideBytes = 0;
+  sideFirst = 0;
+  for (uint8_t i = 0; i < FakeIBus::numChannels; i++) {
+    receiver.setChannel(i, 1000);
+  }
+  waitQuiet(1000);
+}
+
+
+void tearDown() {
+  IBusUart::setSideChannel(sideSync, nullptr);
+}
+
+
+void test_sync_after_gap_reaches_side_channel() {
+  const uint8_t request[sideLength] = {sideSync, 0x01, 0x02};
+  sendBytes(request, sideLength);
+  TEST_ASSERT_EQUAL_INT(sideLength, sideBytes);
+  TEST_ASSERT_EQUAL_INT(sideSync, sideFirst);
+
+  // The line goes back to the decoder after the handler is done
+  uint8_t sequence = IBusUart::decoder.getSequence();
+  uint8_t frame[32];
+  receiver.encodeFrame(frame);
+  sendBytes(frame, sizeof(frame));
+  TEST_ASSERT_EQUAL_INT((uint8_t)(sequence + 1), IBusUart::decoder.getSequence());
+}
+
+
+void test_sync_inside_hunted_frame_goes_to_decoder() {
+  uint8_t frame[32];
+  receiver.setChannel(3, 0x05A5);
+  receiver.encodeFrame(frame);
+  receiver.setChannel(3, 1000);
+
+  // A corrupted length byte leaves the decoder idle, hunting through the frame when the 0xA5 arrives
+  TEST_ASSERT_EQUAL_INT(sideSync, frame[8]);
+  frame[0] = 0x00;
+  sendBytes(frame, sizeof(frame));
+  TEST_ASSERT_TRUE(IBusUart::decoder.isIdle());
+  TEST_ASSERT_EQUAL_INT(0, sideBytes);
+
+  // The next frame is still decoded
+  uint8_t sequence = IBusUart::decoder.getSequence();
+  waitQuiet(2000);
+  receiver.encodeFrame(frame);
+  sendBytes(frame, sizeof(frame));
+  TEST_ASSERT_EQUAL_INT((uint8_t)(sequence + 1), IBusUart::decoder.getSequence());
+  TEST_ASSERT_EQUAL_INT(0, sideBytes);
+}
+
+
+void test_buffered_sync_needs_gap() {
+  // Bytes buffered together lose their timing, so only the first can start a side channel frame
+  const uint8_t late[4] = {0x00, sideSync, 0x01, 0x02};
+  Serial.inject(late, sizeof(late));
+  IBusUart::poll();
+  TEST_ASSERT_EQUAL_INT(0, sideBytes);
+
+  waitQuiet(1000);
+  Serial.inject(&late[1], sizeof(late) - 1);
+  IBusUart::poll();
+  TEST_ASSERT_EQUAL_INT(sideLength, sideBytes);
+}
+
+
+void test_short_gap_rejected() {
+  const uint8_t request[sideLength] = {sideSync, 0x01, 0x02};
+  const uint8_t noise = 0x00;
+  sendBytes(&noise, 1);
+
+  // Less than sideGap after the last byte
+  waitQuiet(IBusUart::sideGap - 200);
+  sendBytes(request, sideLength);
+  TEST_ASSERT_EQUAL_INT(0, sideBytes);
+}
+
+
+void test_read_frame_copies_latest() {
+  uint8_t frame[32];
+  receiver.setChannel(0, 1234);
+  receiver.setChannel(13, 1987);
+  receiver.encodeFrame(frame);
+  sendBytes(frame, sizeof(frame));
+
+  uint8_t lastSequence = IBusUart::decoder.getSequence() - 1;
+  uint16_t channels[IBusDecoder::maxChannels];
+  TEST_ASSERT_TRUE(IBusUart::decoder.readFrame(lastSequence, channels));
+  TEST_ASSERT_EQUAL_INT(1234, channels[0]);
+  TEST_ASSERT_EQUAL_INT(1987, channels[13]);
+  TEST_ASSERT_FALSE(IBusUart::decoder.readFrame(lastSequence, channels));
+
+  // Half of the next frame overwrites the old front buffer, but not the copy
+  receiver.setChannel(0, 1500);
+  receiver.encodeFrame(frame);
+  waitQuiet(1000);
+  sendBytes(frame, sizeof(frame));
+  receiver.setChannel(0, 1600);
+  receiver.encodeFrame(frame);
+  sendBytes(frame, 16);
+  TEST_ASSERT_EQUAL_INT(1234, channels[0]);
+  TEST_ASSERT_TRUE(IBusUart::decoder.readFrame(lastSequence, channels));
+  TEST_ASSERT_EQUAL_INT(1500, channels[0]);
+}
+
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_sync_after_gap_reaches_side_channel);
+  RUN_TEST(test_sync_inside_hunted_frame_goes_to_decoder);
+  RUN_TEST(test_buffered_sync_needs_gap);
+  RUN_TEST(test_short_gap_rejected);
+  RUN_TEST(test_read_frame_copies_latest);
+  return UNITY_END();
+}
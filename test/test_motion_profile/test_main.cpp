@@ -0,0 +1,150 @@
+#include <Arduino.h>
+#include <FakeClock.hpp>
+#include <unity.h>
+
+#include <MotionProfile.hpp>
+
+/*-----------------------------------------------------------------------------*/
+/** @file   test_main.cpp
+ * @brief   MotionProfile straight and S-curve ramps checked against their closed-form values on the fake clock
+*//*---------------------------------------------------------------------------*/
+
+
+const uint32_t callMicros = 10000;  // Time between calls
+const double rateLimit = 40;        // Largest rate in units per second
+const double rateChangeLimit = 80;  // Largest change of the rate in units per second squared
+
+double largestRate = 0;             // Largest rate seen by followProfile()
+double largestRateChange = 0;       // Largest change of the rate per second seen by followProfile()
+                                    // (A call can see one more Q16.16 bit of time than the 10 ms it is divided by)
+
+
+/**
+ * @brief Straight ramp from 0 to 100, then down to 10 once the target changes at 1 s
+ */
+double straightRamp(double t) {
+  return t < 1 ? rateLimit * t : max(rateLimit - rateLimit * (t - 1), 10.0);
+}
+
+
+/**
+ * @brief S-curve from 0 to 100 (0.5 s to reach the rate limit, 2 s at it, 0.5 s to stop)
+ */
+double sCurve(double t) {
+  const double rampTime = rateLimit / rateChangeLimit;
+  const double rampDistance = rateChangeLimit * rampTime * rampTime / 2;
+
+  if (t < rampTime) {
+    return rateChangeLimit * t * t / 2;
+  } else if (t < 2.5) {
+    return rampDistance + rateLimit * (t - rampTime);
+  } else if (t < 3) {
+    return 100 - rateChangeLimit * (3 - t) * (3 - t) / 2;
+  }
+  return 100;
+}
+
+
+/**
+ * @brief S-curve from 0 towards 100 with the target changed to 0 at 1.5 s, while at the rate limit
+ *
+ * @note Brakes from 40 units/s to a stop at 60 by 2 s, then runs a full S-curve back down to 0 by 4 s
+ */
+double sCurveTurnaround(double t) {
+  if (t < 1.5) {
+    return sCurve(t);
+  } else if (t < 2) {
+    return 50 + rateLimit * (t - 1.5) - rateChangeLimit * (t - 1.5) * (t - 1.5) / 2;
+  } else if (t < 2.5) {
+    return 60 - rateChangeLimit * (t - 2) * (t - 2) / 2;
+  } else if (t < 3.5) {
+    return 50 - rateLimit * (t - 2.5);
+  } else if (t < 4) {
+    return rateChangeLimit * (4 - t) * (4 - t) / 2;
+  }
+  return 0;
+}
+
+
+/**
+ * @brief Steps a profile towards a target until a time, checking each value against a closed-form one
+ *
+ * @param profile Profile to step, started at 0 s
+ * @param target Target value
+ * @param endMicros Time since the start to stop at
+ * @param expected Closed-form value at a time in seconds
+ * @return Largest difference between the profile and the closed-form value
+ */
+double followProfile(MotionProfile &profile, int target, uint32_t endMicros, double (*expected)(double)) {
+  double largestError = 0;
+  double lastRate = static_cast<double>(profile.getRate());
+
+  while (FakeClock::now() < endMicros) {
+    FakeClock::advanceMicros(callMicros);
+    int value = profile.calculate(target);
+    double t = FakeClock::now() * 1e-6;
+
+    largestError = max(largestError, fabs(value - expected(t)));
+
+    double rate = static_cast<double>(profile.getRate());
+    largestRate = max(largestRate, fabs(rate));
+    largestRateChange = max(largestRateChange, fabs(rate - lastRate) / (callMicros * 1e-6));
+    lastRate = rate;
+  }
+
+  return largestError;
+}
+
+
+void setUp() {
+  FakeClock::setMicros(0);
+  largestRate = 0;
+  largestRateChange = 0;
+}
+
+
+void tearDown() {}
+
+
+void test_straight_ramp_and_new_target() {
+  MotionProfile profile = MotionProfile(Fixed16(rateLimit));
+
+  // Straight lines within the rounding of the returned value
+  TEST_ASSERT_FLOAT_WITHIN(0.51, 0, followProfile(profile, 100, 1000000, straightRamp));
+  TEST_ASSERT_FLOAT_WITHIN(0.51, 0, followProfile(profile, 10, 2000000, straightRamp));
+  TEST_ASSERT_EQUAL_INT(10, profile.calculate(10));
+  TEST_ASSERT_FLOAT_WITHIN(0.001, rateLimit, largestRate);
+}
+
+
+void test_s_curve() {
+  MotionProfile profile = MotionProfile(Fixed16(rateLimit), Fixed16(rateChangeLimit));
+
+  // The discrete update runs up to half a call behind the continuous curve
+  TEST_ASSERT_FLOAT_WITHIN(1, 0, followProfile(profile, 100, 3500000, sCurve));
+  TEST_ASSERT_EQUAL_INT(100, profile.calculate(100));
+  TEST_ASSERT_FLOAT_WITHIN(0.001, rateLimit, largestRate);
+  TEST_ASSERT_TRUE(largestRateChange <= rateChangeLimit * 1.002);
+}
+
+
+void test_s_curve_target_change_mid_ramp() {
+  MotionProfile profile = MotionProfile(Fixed16(rateLimit), Fixed16(rateChangeLimit));
+
+  TEST_ASSERT_FLOAT_WITHIN(1, 0, followProfile(profile, 100, 1500000, sCurveTurnaround));
+  TEST_ASSERT_FLOAT_WITHIN(0.001, rateLimit, static_cast<double>(profile.getRate()));
+
+  // Turns around without a jump in the rate, so the value peaks at 60 and comes back down
+  TEST_ASSERT_FLOAT_WITHIN(1, 0, followProfile(profile, 0, 4500000, sCurveTurnaround));
+  TEST_ASSERT_EQUAL_INT(0, profile.calculate(0));
+  TEST_ASSERT_TRUE(largestRateChange <= rateChangeLimit * 1.002);
+}
+
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_straight_ramp_and_new_target);
+  RUN_TEST(test_s_curve);
+  RUN_TEST(test_s_curve_target_change_mid_ramp);
+  return UNITY_END();
+}
@@ -0,0 +1,153 @@
+#include <Arduino.h>
+#include <FakeClock.hpp>
+#include <unity.h>
+
+#include <PidCommand.hpp>
+#include <PidExecutor.hpp>
+#include <PidAutoTuner.hpp>
+
+/*-----------------------------------------------------------------------------*/
+/** @file   test_main.cpp
+ * @brief   Relay tuning of a third-order lag against its analytic ultimate gain and period
+*//*---------------------------------------------------------------------------*/
+
+
+const double lagTime = 0.2;               // Time constant of each of the three lags in seconds
+const double ultimateGain = 8;            // Ku of 1 / (0.2s + 1)^3, where each lag gives 60 degrees
+const double ultimatePeriod = 0.7255197;  // Tu = 2 pi tau / sqrt(3)
+const uint32_t plantStepMicros = 1000;    // Time per plant step
+const uint32_t tunerPeriodMicros = 1000;  // Time between tuner updates (Sampling delay lowers the measured Ku)
+
+
+/**
+ * @brief Three equal first-order lags in series with unit gain
+ */
+struct ThirdOrderLag {
+  double stages[3] = {0, 0, 0};
+
+  double update(double command, double dt) {
+    double in = command;
+    for (uint8_t i = 0; i < 3; i++) {
+      stages[i] += (in - stages[i]) * dt / lagTime;
+      in = stages[i];
+    }
+    return stages[2];
+  }
+};
+
+
+/**
+ * @brief Runs a tuner against the plant until it stops or 30 s pass
+ *
+ * @param tuner Tuner to run, already started
+ * @param input Input of the tuned command
+ * @param output Output of the tuned command
+ * @param timeBase Condition for if the tuner is updated with TimeBase::now() instead of update()
+ * @return State the tuner ended in
+ */
+template <class T>
+typename PidAutoTuner<T>::State runTuner(PidAutoTuner<T> &tuner, T &input, T &output, bool timeBase) {
+  ThirdOrderLag plant;
+  typename PidAutoTuner<T>::State state = tuner.getState();
+
+  for (uint32_t t = plantStepMicros; t <= 30000000UL && state == PidAutoTuner<T>::RUNNING; t += plantStepMicros) {
+    FakeClock::advanceMicros(plantStepMicros);
+    input = T(plant.update(static_cast<double>(output), plantStepMicros * 1e-6));
+
+    if (t % tunerPeriodMicros == 0) {
+      state = timeBase ? tuner.update(TimeBase::tick()) : tuner.update();
+    }
+  }
+
+  return state;
+}
+
+
+void setUp() {
+  FakeClock::setMicros(0xFFFFFFFFUL - 2000000); // Crosses the micros() wrap during the run
+}
+
+
+void tearDown() {}
+
+
+void test_pool_command_without_timing_function() {
+  PidExecutor<double, 1> executor;
+  double input = 0, output = 0, setpoint = 1;
+  double range[2] = {0, 2};
+  BasicPidCommand<double> *pid = executor.add(&input, &output, &setpoint, range, 1);
+
+  // Commands from the pool have no timing function, so update() reads the TimeBase
+  PidAutoTuner<double> tuner(*pid);
+  tuner.setHysteresis(0.001);
+  tuner.begin(TimeBase::read(), 4, 30);
+
+  TEST_ASSERT_EQUAL_INT(PidAutoTuner<double>::DONE, runTuner(tuner, input, output, false));
+  TEST_ASSERT_FLOAT_WITHIN(ultimateGain * 0.05, ultimateGain, tuner.getUltimateGain());
+  TEST_ASSERT_FLOAT_WITHIN(ultimatePeriod * 0.05, ultimatePeriod, tuner.getUltimatePeriod());
+  TEST_ASSERT_FLOAT_WITHIN(0.0001, 0, output);
+}
+
+
+void test_fixed_point_time_base() {
+  Fixed16 input = 0, output = 0, setpoint = 1;
+  Fixed16 range[2] = {Fixed16(0), Fixed16(2)};
+  FixedPidCommand pid(&input, &output, &setpoint, range, nullptr, Fixed16(1));
+
+  PidAutoTuner<Fixed16> tuner(pid);
+  tuner.setHysteresis(Fixed16(0.001));
+  tuner.begin(TimeBase::tick(), 4, Fixed16(30));
+
+  TEST_ASSERT_EQUAL_INT(PidAutoTuner<Fixed16>::DONE, runTuner(tuner, input, output, true));
+  TEST_ASSERT_FLOAT_WITHIN(ultimateGain * 0.05, ultimateGain, static_cast<double>(tuner.getUltimateGain()));
+  TEST_ASSERT_FLOAT_WITHIN(ultimatePeriod * 0.05, ultimatePeriod, static_cast<double>(tuner.getUltimatePeriod()));
+}
+
+
+void test_apply_sets_classic_gains() {
+  double input = 0, output = 0, setpoint = 1;
+  double range[2] = {0, 2};
+  PidCommand pid(&input, &output, &setpoint, range, nullptr, 1);
+
+  PidAutoTuner<double> tuner(pid);
+  tuner.setHysteresis(0.001);
+  tuner.begin(TimeBase::read(), 4, 30);
+  TEST_ASSERT_EQUAL_INT(PidAutoTuner<double>::DONE, runTuner(tuner, input, output, false));
+  TEST_ASSERT_TRUE(tuner.apply());
+
+  // Ziegler–Nichols classic PID from the measured Ku and Tu
+  double kP, kI, kD;
+  TEST_ASSERT_TRUE(tuner.getGains(kP, kI, kD));
+  TEST_ASSERT_FLOAT_WITHIN(0.0001, 0.6 * tuner.getUltimateGain(), kP);
+  TEST_ASSERT_FLOAT_WITHIN(0.0001, 1.2 * tuner.getUltimateGain() / tuner.getUltimatePeriod(), kI);
+  TEST_ASSERT_FLOAT_WITHIN(0.0001, 0.075 * tuner.getUltimateGain() * tuner.getUltimatePeriod(), kD);
+
+  GainSet gains;
+  pid.getGains(gains);
+  TEST_ASSERT_FLOAT_WITHIN(0.001, kP, static_cast<double>(gains.kP));
+}
+
+
+void test_deviation_limit_fails() {
+  double input = 0, output = 0, setpoint = 1;
+  double range[2] = {0, 2};
+  PidCommand pid(&input, &output, &setpoint, range, nullptr, 1);
+
+  PidAutoTuner<double> tuner(pid);
+  tuner.setMaxDeviation(0.5);
+  tuner.begin(TimeBase::read(), 4, 30);
+
+  // The input starts a full unit below the setpoint
+  TEST_ASSERT_EQUAL_INT(PidAutoTuner<double>::FAILED, runTuner(tuner, input, output, false));
+  TEST_ASSERT_FLOAT_WITHIN(0.0001, 0, output);
+}
+
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_pool_command_without_timing_function);
+  RUN_TEST(test_fixed_point_time_base);
+  RUN_TEST(test_apply_sets_classic_gains);
+  RUN_TEST(test_deviation_limit_fails);
+  return UNITY_END();
+}
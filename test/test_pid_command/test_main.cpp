@@ -0,0 +1,233 @@
+#include <Arduino.h>
+#include <FakeClock.hpp>
+#include <unity.h>
+
+#include <PidCommand.hpp>
+
+/*-----------------------------------------------------------------------------*/
+/** @file   test_main.cpp
+ * @brief   PidCommand output, clamping, integral and timing checks for both backends
+*//*---------------------------------------------------------------------------*/
+
+
+void setUp() {
+  FakeClock::setMicros(0);
+}
+
+
+void tearDown() {}
+
+
+/**
+ * @brief Input, output and setpoint of a command under test
+ */
+template <class T>
+struct Loop {
+  T input = 0;
+  T output = 0;
+  T setpoint = 0;
+  T range[2] = {T(-100), T(100)};
+};
+
+
+/**
+ * @brief Proportional output is kP times the error
+ */
+template <class T>
+void checkProportional() {
+  Loop<T> loop;
+  BasicPidCommand<T> pid(&loop.input, &loop.output, &loop.setpoint, loop.range, nullptr, T(2));
+  pid.setIntegrationLimit(T(1000));
+  pid.setFixedRate(T(0.01));
+
+  loop.setpoint = T(10);
+  loop.input = T(4);
+  pid.step();
+
+  TEST_ASSERT_FLOAT_WITHIN(0.001, 6, static_cast<double>(pid.getError()));
+  TEST_ASSERT_FLOAT_WITHIN(0.001, 12, static_cast<double>(loop.output));
+}
+
+
+/**
+ * @brief Output stays inside the output range in both directions
+ */
+template <class T>
+void checkClamping() {
+  Loop<T> loop;
+  loop.range[0] = T(0);
+  loop.range[1] = T(50);
+  BasicPidCommand<T> pid(&loop.input, &loop.output, &loop.setpoint, loop.range, nullptr, T(100));
+  pid.setIntegrationLimit(T(1000));
+  pid.setFixedRate(T(0.01));
+
+  loop.setpoint = T(10);
+  pid.step();
+  TEST_ASSERT_FLOAT_WITHIN(0.001, 50, static_cast<double>(loop.output));
+
+  loop.setpoint = T(-10);
+  pid.step();
+  TEST_ASSERT_FLOAT_WITHIN(0.001, 0, static_cast<double>(loop.output));
+}
+
+
+/**
+ * @brief Integral grows by error times dt each step
+ */
+template <class T>
+void checkIntegral() {
+  Loop<T> loop;
+  BasicPidCommand<T> pid(&loop.input, &loop.output, &loop.setpoint, loop.range, nullptr, T(1), T(2));
+  pid.setIntegrationLimit(T(1000));
+  pid.setFixedRate(T(0.01));
+
+  loop.setpoint = T(5);
+  for (uint8_t i = 0; i < 10; i++) {
+    pid.step();
+  }
+
+  // errorSum = 5 * 10 * 0.01, output = 1 * 5 + 2 * 0.5
+  TEST_ASSERT_FLOAT_WITHIN(0.002, 0.5, static_cast<double>(pid.getErrorSum()));
+  TEST_ASSERT_FLOAT_WITHIN(0.005, 6, static_cast<double>(loop.output));
+}
+
+
+/**
+ * @brief Steps timed from the TimeBase measure the time between calls, across the micros() wrap
+ */
+template <class T>
+void checkTimeBaseSteps() {
+  Loop<T> loop;
+  BasicPidCommand<T> pid(&loop.input, &loop.output, &loop.setpoint, loop.range, nullptr, T(0), T(1));
+  pid.setIntegrationLimit(T(1000));
+
+  FakeClock::setMicros(0xFFFFFFFFUL - 25000);
+  pid.reset(TimeBase::tick());
+
+  loop.setpoint = T(1);
+  for (uint8_t i = 0; i < 5; i++) {
+    FakeClock::advanceMicros(10000);
+    pid.calculate(TimeBase::tick());
+  }
+
+  // 50 ms of an error of 1
+  TEST_ASSERT_FLOAT_WITHIN(0.001, 0.05, static_cast<double>(pid.getErrorSum()));
+}
+
+
+double clockSeconds = 0; // Time read by the test timing function
+
+
+/**
+ * @brief Timing function that reads clockSeconds
+ */
+template <class T>
+T readClock() {
+  return T(clockSeconds);
+}
+
+
+/**
+ * @brief The first step from a timing function only seeds its timestamp, however late the clock starts
+ */
+template <class T>
+void checkTimingFunctionFirstStep() {
+  Loop<T> loop;
+  BasicPidCommand<T> pid(&loop.input, &loop.output, &loop.setpoint, loop.range, readClock<T>, T(0), T(1));
+  pid.setIntegrationLimit(T(1000));
+
+  loop.setpoint = T(1);
+  clockSeconds = 1000;
+  pid.calculate();
+  TEST_ASSERT_FLOAT_WITHIN(0.0001, 0, static_cast<double>(pid.getErrorSum()));
+
+  for (uint8_t i = 0; i < 5; i++) {
+    clockSeconds += 0.01;
+    pid.calculate();
+  }
+
+  // 50 ms of an error of 1, not the 1000 s since timestamp 0
+  TEST_ASSERT_FLOAT_WITHIN(0.001, 0.05, static_cast<double>(pid.getErrorSum()));
+}
+
+
+/**
+ * @brief The first step timed from the TimeBase only seeds its time, however long after construction it comes
+ */
+template <class T>
+void checkTimeBaseFirstStep() {
+  Loop<T> loop;
+  BasicPidCommand<T> pid(&loop.input, &loop.output, &loop.setpoint, loop.range, nullptr, T(0), T(1));
+  pid.setIntegrationLimit(T(1000));
+
+  // Setup, parameter loading and the arming wait before the first step
+  loop.setpoint = T(1);
+  FakeClock::advanceMicros(5000000);
+  pid.calculate();
+  TEST_ASSERT_FLOAT_WITHIN(0.0001, 0, static_cast<double>(pid.getErrorSum()));
+
+  for (uint8_t i = 0; i < 5; i++) {
+    FakeClock::advanceMicros(10000);
+    pid.calculate();
+  }
+
+  // 50 ms of an error of 1, not the 5 s since construction
+  TEST_ASSERT_FLOAT_WITHIN(0.001, 0.05, static_cast<double>(pid.getErrorSum()));
+}
+
+
+/**
+ * @brief An emergency stop holds the output at 0
+ */
+template <class T>
+void checkEStop() {
+  Loop<T> loop;
+  BasicPidCommand<T> pid(&loop.input, &loop.output, &loop.setpoint, loop.range, nullptr, T(1));
+  pid.setIntegrationLimit(T(1000));
+  pid.setFixedRate(T(0.01));
+
+  loop.setpoint = T(20);
+  pid.step();
+  TEST_ASSERT_FLOAT_WITHIN(0.001, 20, static_cast<double>(loop.output));
+
+  pid.eStop();
+  pid.step();
+  TEST_ASSERT_TRUE(pid.isEStopped());
+  TEST_ASSERT_FLOAT_WITHIN(0.001, 0, static_cast<double>(loop.output));
+}
+
+
+void test_proportional_double() { checkProportional<double>(); }
+void test_proportional_fixed() { checkProportional<Fixed16>(); }
+void test_clamping_double() { checkClamping<double>(); }
+void test_clamping_fixed() { checkClamping<Fixed16>(); }
+void test_integral_double() { checkIntegral<double>(); }
+void test_integral_fixed() { checkIntegral<Fixed16>(); }
+void test_time_base_steps_double() { checkTimeBaseSteps<double>(); }
+void test_time_base_steps_fixed() { checkTimeBaseSteps<Fixed16>(); }
+void test_time_base_first_step_double() { checkTimeBaseFirstStep<double>(); }
+void test_time_base_first_step_fixed() { checkTimeBaseFirstStep<Fixed16>(); }
+void test_timing_function_first_step_double() { checkTimingFunctionFirstStep<double>(); }
+void test_timing_function_first_step_fixed() { checkTimingFunctionFirstStep<Fixed16>(); }
+void test_estop_double() { checkEStop<double>(); }
+void test_estop_fixed() { checkEStop<Fixed16>(); }
+
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_proportional_double);
+  RUN_TEST(test_proportional_fixed);
+  RUN_TEST(test_clamping_double);
+  RUN_TEST(test_clamping_fixed);
+  RUN_TEST(test_integral_double);
+  RUN_TEST(test_integral_fixed);
+  RUN_TEST(test_time_base_steps_double);
+  RUN_TEST(test_time_base_steps_fixed);
+  RUN_TEST(test_time_base_first_step_double);
+  RUN_TEST(test_time_base_first_step_fixed);
+  RUN_TEST(test_timing_function_first_step_double);
+  RUN_TEST(test_timing_function_first_step_fixed);
+  RUN_TEST(test_estop_double);
+  RUN_TEST(test_estop_fixed);
+  return UNITY_END();
+}
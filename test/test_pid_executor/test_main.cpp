@@ -0,0 +1,158 @@
+#include <Arduino.h>
+#include <FakeClock.hpp>
+#include <unity.h>
+
+#include <ControlTimer.hpp>
+#include <PidExecutor.hpp>
+
+/*-----------------------------------------------------------------------------*/
+/** @file   test_main.cpp
+ * @brief   ControlTimer tick release and PidExecutor stepping from the timer, from TimeMicros and from seconds
+*//*---------------------------------------------------------------------------*/
+
+
+const uint16_t periodMillis = 10;  // Time between control ticks
+const double kI = 2;               // Integral gain of the test controllers (No other terms, so the output is kI times the integral)
+
+
+/**
+ * @brief Pool of two integrating controllers, the second running every other tick
+ */
+template <class T>
+struct Pool {
+  PidExecutor<T, 2> executor;
+  T input = 0, setpoint = 1;
+  T outputs[2] = {0, 0};
+  T range[2] = {T(-100), T(100)};
+
+  Pool() {
+    for (uint8_t i = 0; i < 2; i++) {
+      executor.add(&input, &outputs[i], &setpoint, range, T(0), T(kI), T(0), i + 1)->setIntegrationLimit(T(100));
+    }
+  }
+};
+
+
+/**
+ * @brief Runs a pool from ControlTimer ticks for a time
+ *
+ * @param pool Pool to run
+ * @param runMillis Time to run for
+ * @param stamp Timestamp the pool is ticked with: 0 for the fixed period, 1 for TimeMicros, 2 for seconds
+ * @return Number of ticks taken
+ */
+template <class T>
+uint16_t runPool(Pool<T> &pool, uint32_t runMillis, uint8_t stamp) {
+  uint16_t ticks = 0;
+
+  for (uint32_t t = 0; t < runMillis; t++) {
+    FakeClock::advanceMicros(1000);
+
+    if (ControlTimer::takeTick()) {
+      if (stamp == 0) {
+        pool.executor.tick();
+      } else if (stamp == 1) {
+        pool.executor.tick(TimeBase::tick());
+      } else {
+        pool.executor.tick(T(micros() * 1e-6));
+      }
+      ticks++;
+    }
+  }
+
+  return ticks;
+}
+
+
+/**
+ * @brief Every way of ticking integrates the same error over the same time, whatever the divisor
+ */
+template <class T>
+void checkTickPaths() {
+  for (uint8_t stamp = 0; stamp < 3; stamp++) {
+    FakeClock::setMicros(0);
+    ControlTimer::begin(periodMillis);
+    Pool<T> pool;
+    pool.executor.setFixedRate(T(periodMillis * 1e-3));
+
+    // The first tick only restarts the timing, then 1 s of steps at 100 Hz and 50 Hz
+    TEST_ASSERT_EQUAL_INT(1, runPool(pool, periodMillis, stamp));
+    TEST_ASSERT_EQUAL_INT(100, runPool(pool, 1000, stamp));
+
+    TEST_ASSERT_FLOAT_WITHIN_MESSAGE(0.01, kI, static_cast<double>(pool.outputs[0]), "every tick");
+    TEST_ASSERT_FLOAT_WITHIN_MESSAGE(0.01, kI, static_cast<double>(pool.outputs[1]), "every other tick");
+  }
+}
+
+
+void setUp() {
+  FakeClock::setMicros(0);
+}
+
+
+void tearDown() {
+  ControlTimer::end();
+}
+
+
+void test_timer_releases_ticks() {
+  ControlTimer::begin(periodMillis);
+  TEST_ASSERT_EQUAL_INT(periodMillis * 1000, ControlTimer::getPeriodMicros());
+
+  FakeClock::advanceMicros(periodMillis * 1000 - 1);
+  TEST_ASSERT_FALSE(ControlTimer::takeTick());
+  FakeClock::advanceMicros(1);
+  TEST_ASSERT_TRUE(ControlTimer::takeTick());
+  TEST_ASSERT_FALSE(ControlTimer::takeTick());
+}
+
+
+void test_timer_counts_missed_ticks() {
+  ControlTimer::begin(periodMillis);
+  uint16_t missed = ControlTimer::getMissed();
+
+  // Three periods without taking a tick leave one pending and two missed
+  FakeClock::advanceMicros(periodMillis * 3000);
+  TEST_ASSERT_TRUE(ControlTimer::takeTick());
+  TEST_ASSERT_FALSE(ControlTimer::takeTick());
+  TEST_ASSERT_EQUAL_INT(missed + 2, ControlTimer::getMissed());
+
+  ControlTimer::end();
+  FakeClock::advanceMicros(periodMillis * 1000);
+  TEST_ASSERT_FALSE(ControlTimer::takeTick());
+}
+
+
+void test_double_tick_paths() { checkTickPaths<double>(); }
+void test_fixed_tick_paths() { checkTickPaths<Fixed16>(); }
+
+
+void test_disabled_controller_restarts() {
+  ControlTimer::begin(periodMillis);
+  Pool<double> pool;
+  pool.executor.setFixedRate(periodMillis * 1e-3);
+  runPool(pool, 500, 0);
+
+  int id = pool.executor.get(0)->getCommandID();
+  TEST_ASSERT_TRUE(pool.executor.setEnabled(id, false));
+  double held = pool.outputs[0];
+  runPool(pool, 500, 0);
+  TEST_ASSERT_FLOAT_WITHIN(0.0001, held, pool.outputs[0]);
+
+  // Enabling spends one tick restarting with a cleared integral, so the time off isn't integrated
+  TEST_ASSERT_TRUE(pool.executor.setEnabled(id));
+  runPool(pool, 500 + periodMillis, 0);
+  TEST_ASSERT_FLOAT_WITHIN(0.01, kI * 0.5, pool.outputs[0]);
+  TEST_ASSERT_FLOAT_WITHIN(0.01, kI * 1.5, pool.outputs[1]);
+}
+
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_timer_releases_ticks);
+  RUN_TEST(test_timer_counts_missed_ticks);
+  RUN_TEST(test_double_tick_paths);
+  RUN_TEST(test_fixed_tick_paths);
+  RUN_TEST(test_disabled_controller_restarts);
+  return UNITY_END();
+}
@@ -0,0 +1,220 @@
+#include <Arduino.h>
+#include <FakeClock.hpp>
+#include <unity.h>
+
+#include <SlewRateLimiter.hpp>
+#include <IntSlewRateLimiter.hpp>
+#include <SlewRateLimiterBank.hpp>
+
+/*-----------------------------------------------------------------------------*/
+/** @file   test_main.cpp
+ * @brief   Ramp timing checks for SlewRateLimiter, IntSlewRateLimiter and SlewRateLimiterBank on the fake clock
+*//*---------------------------------------------------------------------------*/
+
+
+void setUp() {
+  FakeClock::setMicros(0);
+}
+
+
+void tearDown() {}
+
+
+/**
+ * @brief Steps an integer limiter towards a target at a fixed call period
+ *
+ * @param limiter Limiter to step
+ * @param target Target value
+ * @param periodMicros Time between calls
+ * @param totalMicros Time to run for
+ * @return Value after the last call
+ */
+int rampInt(IntSlewRateLimiter &limiter, int target, uint32_t periodMicros, uint32_t totalMicros) {
+  int value = 0;
+
+  for (uint32_t t = 0; t < totalMicros; t += periodMicros) {
+    FakeClock::advanceMicros(periodMicros);
+    value = limiter.calculate(target);
+  }
+
+  return value;
+}
+
+
+void test_double_ramp_rate() {
+  SlewRateLimiter limiter(30);
+
+  double value = 0;
+  for (uint8_t i = 0; i < 50; i++) {
+    FakeClock::advanceMicros(20000);
+    value = limiter.calculate(100);
+  }
+
+  // 30 units/s for 1 s
+  TEST_ASSERT_FLOAT_WITHIN(0.01, 30, value);
+}
+
+
+void test_double_asymmetric_rate() {
+  SlewRateLimiter limiter(100, 50);
+
+  for (uint8_t i = 0; i < 50; i++) {
+    FakeClock::advanceMicros(20000);
+    limiter.calculate(100);
+  }
+
+  double value = 0;
+  for (uint8_t i = 0; i < 25; i++) {
+    FakeClock::advanceMicros(20000);
+    value = limiter.calculate(0);
+  }
+
+  // Up at 100 units/s for 1 s, then down at 50 units/s for 0.5 s
+  TEST_ASSERT_FLOAT_WITHIN(0.01, 75, value);
+}
+
+
+void test_int_ramp_rate() {
+  IntSlewRateLimiter limiter(30);
+
+  TEST_ASSERT_EQUAL_INT(15, rampInt(limiter, 100, 20000, 500000));
+  TEST_ASSERT_EQUAL_INT(30, rampInt(limiter, 100, 20000, 500000));
+}
+
+
+void test_int_reaches_target() {
+  IntSlewRateLimiter limiter(30);
+
+  TEST_ASSERT_EQUAL_INT(20, rampInt(limiter, 20, 20000, 2000000));
+}
+
+
+void test_int_asymmetric_rate() {
+  IntSlewRateLimiter limiter(60, 30);
+  limiter.reset(90);
+
+  // Down at 30 units/s for 1 s
+  TEST_ASSERT_EQUAL_INT(60, rampInt(limiter, 0, 20000, 1000000));
+}
+
+
+void test_int_rate_independent_of_call_period() {
+  const uint32_t periods[] = {100, 500, 1000, 4000, 20000};
+
+  for (uint8_t i = 0; i < sizeof(periods) / sizeof(periods[0]); i++) {
+    FakeClock::setMicros(0);
+    IntSlewRateLimiter limiter(30);
+
+    // 30 units/s for 1 s, however often it is called
+    TEST_ASSERT_EQUAL_INT_MESSAGE(30, rampInt(limiter, 100, periods[i], 1000000), "call period");
+  }
+}
+
+
+void test_int_slow_rate_fast_calls() {
+  IntSlewRateLimiter limiter(1);
+
+  // 1 unit/s called at 10 kHz still moves one unit in a second
+  TEST_ASSERT_EQUAL_INT(1, rampInt(limiter, 100, 100, 1000000));
+}
+
+
+void test_int_across_wrap() {
+  FakeClock::setMicros(0xFFFFFFFFUL - 300000);
+  IntSlewRateLimiter limiter(30);
+
+  TEST_ASSERT_EQUAL_INT(30, rampInt(limiter, 100, 20000, 1000000));
+}
+
+
+void test_int_fixed_value_between_units() {
+  IntSlewRateLimiter limiter(30);
+
+  // 10 ms at 30 units/s is 0.3 units, which the whole value rounds away
+  TEST_ASSERT_EQUAL_INT(0, rampInt(limiter, 100, 10000, 10000));
+  TEST_ASSERT_FLOAT_WITHIN(0.005, 0.3, static_cast<double>(limiter.getFixedValue()));
+
+  limiter.reset(90);
+  TEST_ASSERT_FLOAT_WITHIN(0.0001, 90, static_cast<double>(limiter.getFixedValue()));
+}
+
+
+void test_bank_matches_single_limiter() {
+  SlewRateLimiterBank<2> bank(30);
+  bank.setRate(1, 45, 90);
+  IntSlewRateLimiter first(30);
+  IntSlewRateLimiter second(45, 90);
+
+  const int targets[2] = {100, 100};
+  const int reverse[2] = {-100, -100};
+  int outputs[2];
+
+  // Every channel steps exactly like its own limiter, at a rate fast enough to need the carry
+  for (uint16_t i = 0; i < 3000; i++) {
+    FakeClock::advanceMicros(500);
+    const int *target = i < 2000 ? targets : reverse;
+    TimeMicros now = TimeBase::read();
+
+    bank.calculate(target, outputs, now);
+    TEST_ASSERT_EQUAL_INT(first.calculate(target[0], now), outputs[0]);
+    TEST_ASSERT_EQUAL_INT(second.calculate(target[1], now), outputs[1]);
+  }
+
+  // 1 s up and 0.5 s down from 30 and 45
+  TEST_ASSERT_EQUAL_INT(15, outputs[0]);
+  TEST_ASSERT_EQUAL_INT(0, outputs[1]);
+}
+
+
+void test_bank_rate_independent_of_call_period() {
+  const uint32_t periods[] = {100, 1000, 20000};
+  const int targets[3] = {100, -100, 5};
+  int outputs[3];
+
+  for (uint8_t p = 0; p < sizeof(periods) / sizeof(periods[0]); p++) {
+    FakeClock::setMicros(0);
+    SlewRateLimiterBank<3> bank(30);
+
+    for (uint32_t t = 0; t < 1000000; t += periods[p]) {
+      FakeClock::advanceMicros(periods[p]);
+      bank.calculate(targets, outputs);
+    }
+
+    TEST_ASSERT_EQUAL_INT_MESSAGE(30, outputs[0], "call period");
+    TEST_ASSERT_EQUAL_INT_MESSAGE(-30, outputs[1], "call period");
+    TEST_ASSERT_EQUAL_INT_MESSAGE(5, outputs[2], "call period");
+  }
+}
+
+
+void test_bank_reset() {
+  SlewRateLimiterBank<2> bank(30);
+  bank.reset(1, 80);
+  TEST_ASSERT_EQUAL_INT(80, bank.getValue(1));
+
+  const int targets[2] = {0, 80};
+  int outputs[2];
+  FakeClock::advanceMicros(20000);
+  bank.calculate(targets, outputs);
+
+  TEST_ASSERT_EQUAL_INT(0, outputs[0]);
+  TEST_ASSERT_EQUAL_INT(80, outputs[1]);
+}
+
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_double_ramp_rate);
+  RUN_TEST(test_double_asymmetric_rate);
+  RUN_TEST(test_int_ramp_rate);
+  RUN_TEST(test_int_reaches_target);
+  RUN_TEST(test_int_asymmetric_rate);
+  RUN_TEST(test_int_rate_independent_of_call_period);
+  RUN_TEST(test_int_slow_rate_fast_calls);
+  RUN_TEST(test_int_across_wrap);
+  RUN_TEST(test_int_fixed_value_between_units);
+  RUN_TEST(test_bank_matches_single_limiter);
+  RUN_TEST(test_bank_rate_independent_of_call_period);
+  RUN_TEST(test_bank_reset);
+  return UNITY_END();
+}
@@ -0,0 +1,98 @@
+#include <Arduino.h>
+#include <unity.h>
+
+#include <TimeBase.hpp>
+
+/*-----------------------------------------------------------------------------*/
+/** @file   test_main.cpp
+ * @brief   TimeBase::toSeconds checks against the exact conversion (The Fixed16 one is what PID steps use on AVR)
+*//*---------------------------------------------------------------------------*/
+
+
+const uint32_t edgeChanges[] = {
+  0, 1, 15, 16, 999, 1000, 10000, 20000, 65535, 65536, 65537, 1000000, 999999, 1000001,
+  0x00FFFFFF, 0x7FFFFFFF, 0x80000000, 0xFFFF0000, 0xFFFFFFFE, 0xFFFFFFFF
+};
+
+uint32_t randomState = 1;
+
+
+/**
+ * @brief Gets the next value of a xorshift generator, spread across every magnitude
+ */
+uint32_t nextRandom() {
+  randomState ^= randomState << 13;
+  randomState ^= randomState >> 17;
+  randomState ^= randomState << 5;
+
+  // Shifts by a random amount so short times come up as often as long ones
+  return randomState >> (randomState & 31);
+}
+
+
+/**
+ * @brief Gets how far the Fixed16 conversion is above the exact floor(change * 65536 / 10^6)
+ *
+ * @param change Time change in microseconds
+ * @return Difference in raw bits (0 or 1 when correct)
+ */
+int64_t fixedError(uint32_t change) {
+  int64_t exact = (int64_t)(((uint64_t)change << 16) / 1000000);
+  return (int64_t)(uint32_t)TimeBase::toSeconds<Fixed16>(change).getRaw() - exact;
+}
+
+
+void setUp() {}
+
+
+void tearDown() {}
+
+
+void test_fixed_edge_values() {
+  for (uint8_t i = 0; i < sizeof(edgeChanges) / sizeof(edgeChanges[0]); i++) {
+    int64_t error = fixedError(edgeChanges[i]);
+    TEST_ASSERT_TRUE_MESSAGE(error == 0 || error == 1, "edge value");
+  }
+
+  // Whole seconds and the motor task period land on the exact floor
+  TEST_ASSERT_EQUAL_INT(65536, TimeBase::toSeconds<Fixed16>(1000000).getRaw());
+  TEST_ASSERT_EQUAL_INT(1310, TimeBase::toSeconds<Fixed16>(20000).getRaw());
+}
+
+
+void test_fixed_every_short_change() {
+  // Every change up to 0.2 s, which covers any control period
+  uint32_t mismatches = 0;
+  for (uint32_t change = 0; change <= 200000; change++) {
+    int64_t error = fixedError(change);
+    mismatches += error != 0 && error != 1;
+  }
+  TEST_ASSERT_EQUAL_INT(0, mismatches);
+}
+
+
+void test_fixed_random_changes() {
+  randomState = 1;
+  uint32_t mismatches = 0;
+  for (uint32_t i = 0; i < 1000000; i++) {
+    int64_t error = fixedError(nextRandom());
+    mismatches += error != 0 && error != 1;
+  }
+  TEST_ASSERT_EQUAL_INT(0, mismatches);
+}
+
+
+void test_double() {
+  TEST_ASSERT_FLOAT_WITHIN(1e-12, 0.02, TimeBase::toSeconds<double>(20000));
+  TEST_ASSERT_FLOAT_WITHIN(1e-6, 4294.967295, TimeBase::toSeconds<double>(0xFFFFFFFF));
+}
+
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_fixed_edge_values);
+  RUN_TEST(test_fixed_every_short_change);
+  RUN_TEST(test_fixed_random_changes);
+  RUN_TEST(test_double);
+  return UNITY_END();
+}
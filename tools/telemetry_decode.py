@@ -0,0 +1,152 @@
+#!/usr/bin/env python3
+"""Decodes the binary telemetry stream from lib/Telemetry into Teleplot lines or CSV.
+
+Records are COBS encoded and end with a 0x00 byte. Once decoded, a record is:
+    type u8, id u8, sequence u8, timestamp u32 (us), format u8, count u8,
+    values (count x int16 / float32 / Q16.16 int32 / int32), CRC-16/CCITT u16
+Multi-byte fields are little-endian. Records that fail the CRC, like text printed
+on the same port, are skipped.
+
+Examples:
+    python3 tools/telemetry_decode.py --port /dev/ttyACM0            # Teleplot lines
+    python3 tools/telemetry_decode.py --csv capture.bin > samples.csv
+"""
+
+import argparse
+import struct
+import sys
+
+# Value names of the record types known to the firmware (Telemetry::RecordType)
+RECORD_NAMES = {
+    1: ("pid", ["setpoint", "p", "i", "d", "input", "output"]),
+    2: ("motor", ["output", "percent"]),
+    3: ("rc", ["ch%d" % (i + 1) for i in range(10)]),
+    4: ("param", ["command", "status", "value"]),
+    5: ("capture", ["offset"]),
+    6: ("task", ["runs", "overruns", "jitter", "max_jitter", "max_run"]),
+    7: ("stage", ["count", "min", "max", "overruns", "budget"]),
+    8: ("stage", ["lt%d" % (1 << b) for b in range(15)] + ["inf"]),
+}
+
+HEADER = struct.Struct("<BBBIBB")
+
+
+def crc16(data):
+    crc = 0xFFFF
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else crc << 1
+        crc &= 0xFFFF
+    return crc
+
+
+def cobs_decode(data):
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        if code == 0 or i + code > len(data):
+            return None
+        out += data[i + 1:i + code]
+        i += code
+        if code < 0xFF and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+def parse_record(frame):
+    raw = cobs_decode(frame)
+    if raw is None or len(raw) < HEADER.size + 2:
+        return None
+    if crc16(raw[:-2]) != struct.unpack_from("<H", raw, len(raw) - 2)[0]:
+        return None
+
+    rtype, rid, seq, timestamp, fmt, count = HEADER.unpack_from(raw)
+    body = raw[HEADER.size:-2]
+    if fmt == 0 and len(body) == 2 * count:
+        values = list(struct.unpack("<%dh" % count, body))
+    elif fmt == 1 and len(body) == 4 * count:
+        values = list(struct.unpack("<%df" % count, body))
+    elif fmt == 2 and len(body) == 4 * count:
+        values = [v / 65536.0 for v in struct.unpack("<%di" % count, body)]
+    elif fmt == 3 and len(body) == 4 * count:
+        values = list(struct.unpack("<%di" % count, body))
+    else:
+        return None
+    return rtype, rid, seq, timestamp, values
+
+
+def record_labels(rtype, rid, count):
+    prefix, names = RECORD_NAMES.get(rtype, ("type%d" % rtype, []))
+    if rtype == 1:
+        prefix = "pid%d" % rid
+    elif rtype == 4:
+        prefix = "param%d" % rid
+    elif rtype == 5:
+        prefix = "capture%d" % rid
+    elif rtype == 6:
+        prefix = "task%d" % rid
+    elif rtype in (7, 8):
+        prefix = "stage%d" % rid
+    names = names + ["v%d" % i for i in range(len(names), count)]
+    return ["%s_%s" % (prefix, name) for name in names[:count]]
+
+
+def frames(stream):
+    pending = bytearray()
+    while True:
+        chunk = stream.read(256)
+        if not chunk:
+            return
+        pending += chunk
+        while True:
+            end = pending.find(b"\x00")
+            if end < 0:
+                break
+            yield bytes(pending[:end])
+            del pending[:end + 1]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("input", nargs="?", help="Capture file to read (Default stdin)")
+    parser.add_argument("--port", help="Serial port to read from (Needs pyserial)")
+    parser.add_argument("--baud", type=int, default=115200, help="Baudrate of the serial port")
+    parser.add_argument("--csv", action="store_true", help="Print CSV rows instead of Teleplot lines")
+    args = parser.parse_args()
+
+    if args.port:
+        import serial
+        stream = serial.Serial(args.port, args.baud, timeout=1)
+    elif args.input:
+        stream = open(args.input, "rb")
+    else:
+        stream = sys.stdin.buffer
+
+    last_seq = None
+    lost = 0
+    if args.csv:
+        print("time_us,type,id,seq,values")
+
+    for frame in frames(stream):
+        record = parse_record(frame)
+        if record is None:
+            continue
+
+        rtype, rid, seq, timestamp, values = record
+        if last_seq is not None:
+            lost += (seq - last_seq - 1) & 0xFF
+        last_seq = seq
+
+        if args.csv:
+            print("%d,%d,%d,%d,%s" % (timestamp, rtype, rid, seq, ",".join("%g" % v for v in values)))
+        else:
+            for label, value in zip(record_labels(rtype, rid, len(values)), values):
+                print(">%s:%d:%g" % (label, timestamp // 1000, value))
+            print(">telemetry_lost:%d:%d" % (timestamp // 1000, lost))
+        sys.stdout.flush()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,173 @@
+#!/usr/bin/env python3
+"""Reads and changes the firmware's parameters while it runs (lib/TuningLink).
+
+Requests share the iBus RX line and are sent between iBus frames, so the receiver must be wired
+to D0 through a diode (See TuningLink in the README). Each one is:
+    sync 0xA5, command u8, id u8, value i32, CRC-16/CCITT u16 of command, id and value
+Multi-byte fields are little-endian. Responses are telemetry PARAM records (type 4) with
+int32 values: command, status, then the command's values. A request that collides with an
+iBus frame is dropped by the firmware, so it is sent again until a response arrives.
+
+Changes only live in RAM until `commit` saves them to EEPROM. `snapshot` marks a known good
+set of values and `revert` goes back to it (Startup takes a snapshot too).
+
+Examples:
+    python3 tools/tune.py --port /dev/ttyACM0 list
+    python3 tools/tune.py --port /dev/ttyACM0 set motor_change_limit 45
+    python3 tools/tune.py --port /dev/ttyACM0 commit
+"""
+
+import argparse
+import struct
+import sys
+import time
+
+from telemetry_decode import crc16, parse_record
+
+# Parameter names in ID order, same order as the tunables table in src/main.cpp
+PARAM_NAMES = [
+    "joystick_low", "joystick_high",
+    "throttle_low", "throttle_high",
+    "switch_low", "switch_high",
+    "c_switch_low", "c_switch_mid", "c_switch_high",
+    "knob_low", "knob_high",
+    "motor_change_limit",
+    "failsafe_ramp_rate",
+    "sample_rate",
+]
+
+# TuningLink::Command
+GET, SET, INFO, COUNT, SNAPSHOT, REVERT, COMMIT = range(1, 8)
+
+# TuningLink::Status
+STATUS_NAMES = ["ok", "bad id", "out of range", "busy", "failed", "bad command"]
+
+# TuningLink::ParamType
+TYPE_NAMES = ["int", "uint16", "uint32", "int32", "fixed16"]
+FIXED16 = 4
+
+SYNC = 0xA5
+ALL_PARAMS = 0xFF
+PARAM_RECORD = 4
+
+
+class TuningError(Exception):
+    pass
+
+
+class Link:
+    def __init__(self, port, baud, retries):
+        import serial
+        # DTR resets the Uno on most boards, so it is kept low to tune without a restart
+        self.serial = serial.Serial()
+        self.serial.port = port
+        self.serial.baudrate = baud
+        self.serial.timeout = 0.05
+        self.serial.dtr = False
+        self.serial.open()
+        self.retries = retries
+        self.pending = bytearray()
+
+    def request(self, command, pid=0, value=0, timeout=0.3):
+        body = struct.pack("<BBi", command, pid, value)
+        frame = bytes([SYNC]) + body + struct.pack("<H", crc16(body))
+        expected_id = pid if command in (GET, SET, INFO) else ALL_PARAMS
+
+        for _ in range(self.retries):
+            self.serial.write(frame)
+            deadline = time.monotonic() + timeout
+            while time.monotonic() < deadline:
+                record = self.read_record()
+                if record is None:
+                    continue
+                rtype, rid, _, _, values = record
+                if rtype == PARAM_RECORD and rid == expected_id and values and values[0] == command:
+                    status = values[1]
+                    if status != 0:
+                        raise TuningError(STATUS_NAMES[status] if status < len(STATUS_NAMES) else "status %d" % status)
+                    return values[2:]
+        raise TuningError("no response")
+
+    def read_record(self):
+        end = self.pending.find(b"\x00")
+        if end < 0:
+            self.pending += self.serial.read(256)
+            end = self.pending.find(b"\x00")
+            if end < 0:
+                return None
+        frame = bytes(self.pending[:end])
+        del self.pending[:end + 1]
+        return parse_record(frame)
+
+
+def param_id(name):
+    if name.isdigit():
+        return int(name)
+    if name not in PARAM_NAMES:
+        raise TuningError("unknown parameter %s (Known: %s)" % (name, ", ".join(PARAM_NAMES)))
+    return PARAM_NAMES.index(name)
+
+
+def param_name(pid):
+    return PARAM_NAMES[pid] if pid < len(PARAM_NAMES) else "param%d" % pid
+
+
+def to_display(ptype, raw):
+    return "%g" % (raw / 65536.0) if ptype == FIXED16 else "%d" % raw
+
+
+def to_raw(ptype, text):
+    return int(round(float(text) * 65536)) if ptype == FIXED16 else int(text, 0)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--port", required=True, help="Serial port of the board (Needs pyserial)")
+    parser.add_argument("--baud", type=int, default=115200, help="Baudrate of the serial port")
+    parser.add_argument("--retries", type=int, default=10, help="Times to send a request before giving up")
+    commands = parser.add_subparsers(dest="command")
+    commands.required = True
+    commands.add_parser("list", help="Print every parameter with its value and range")
+    get_parser = commands.add_parser("get", help="Print a parameter")
+    get_parser.add_argument("param", help="Parameter name or ID")
+    set_parser = commands.add_parser("set", help="Change a parameter in RAM")
+    set_parser.add_argument("param", help="Parameter name or ID")
+    set_parser.add_argument("value", help="New value (Decimal for fixed16 parameters)")
+    commands.add_parser("snapshot", help="Mark the current values as the ones revert goes back to")
+    commands.add_parser("revert", help="Go back to the last snapshot")
+    commands.add_parser("commit", help="Save the current values to EEPROM")
+    args = parser.parse_args()
+
+    try:
+        link = Link(args.port, args.baud, args.retries)
+
+        if args.command == "list":
+            count = link.request(COUNT)[0]
+            for pid in range(count):
+                ptype, low, high = link.request(INFO, pid)
+                value = link.request(GET, pid)[0]
+                print("%3d %-20s %10s  [%s, %s] %s" % (pid, param_name(pid), to_display(ptype, value),
+                      to_display(ptype, low), to_display(ptype, high), TYPE_NAMES[ptype]))
+        elif args.command in ("get", "set"):
+            pid = param_id(args.param)
+            ptype = link.request(INFO, pid)[0]
+            if args.command == "set":
+                value = link.request(SET, pid, to_raw(ptype, args.value))[0]
+            else:
+                value = link.request(GET, pid)[0]
+            print("%s = %s" % (param_name(pid), to_display(ptype, value)))
+        elif args.command == "snapshot":
+            link.request(SNAPSHOT)
+        elif args.command == "revert":
+            link.request(REVERT)
+        elif args.command == "commit":
+            saves = link.request(COMMIT, timeout=2.0)[0]
+            print("saved (save %d)" % saves)
+    except TuningError as error:
+        print("error: %s" % error, file=sys.stderr)
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())